@@ -27,6 +27,17 @@ public class MultiverseConnector : ModuleRules
       }
       );
 
+    PrivateDependencyModuleNames.AddRange(
+      new string[]
+      {
+        "Chaos",
+        "ImageWrapper",
+        "PhysicsCore",
+        "RenderCore",
+        "RHI",
+      }
+      );
+
     if (Target.Platform == UnrealTargetPlatform.Win64)
     {
       PrivateDependencyModuleNames.AddRange(
@@ -2,6 +2,8 @@
 
 #include "AnimNode_ModifyBones.h"
 #include "Animation/AnimInstanceProxy.h"
+#include "MultiverseAnim.h"
+#include "MultiverseSkeletonJoints.h"
 
 FAnimNode_ModifyBones::FAnimNode_ModifyBones()
 {
@@ -14,28 +16,68 @@ void FAnimNode_ModifyBones::EvaluateSkeletalControl_AnyThread(FComponentSpacePos
 	check(OutBoneTransforms.Num() == 0);
 
 	const FBoneContainer& BoneContainer = Output.Pose.GetPose().GetBoneContainer();
+	const int32 NumBones = BoneContainer.GetCompactPoseNumBones();
+	if (BonesToModify.Num() == 0 || JointNames.Num() != NumBones)
+	{
+		return;
+	}
 
-	FTransform ComponentTransform = Output.AnimInstanceProxy->GetComponentTransform();
-	for (const FBoneReference& BoneToModify : BonesToModify)
+	// Joint poses streamed into a Multiverse anim instance are read from its published joint state, the pin is the fallback
+	UMultiverseAnim* MultiverseAnim = Cast<UMultiverseAnim>(Output.AnimInstanceProxy->GetAnimInstanceObject());
+	const FMultiverseJointState* JointState = MultiverseAnim != nullptr ? &MultiverseAnim->ReadJointState() : nullptr;
+	if (JointState != nullptr && JointState->Sequence == 0)
+	{
+		JointState = nullptr;
+	}
+	if (JointState != nullptr && (JointStateOwner != MultiverseAnim || JointStateIndices.Num() != NumBones))
 	{
-		if (!JointPoses.Contains(BoneToModify.BoneName))
+		JointStateOwner = MultiverseAnim;
+		JointStateIndices.Init(INDEX_NONE, NumBones);
+		for (int32 Index = 0; Index < NumBones; ++Index)
 		{
-			continue;
+			if (!JointNames[Index].IsNone())
+			{
+				JointStateIndices[Index] = MultiverseAnim->FindJointIndex(JointNames[Index]);
+			}
 		}
+	}
 
-		FCompactPoseBoneIndex CompactPoseBoneToModifyIndex = BoneToModify.GetCompactPoseIndex(BoneContainer);
-
-		// Convert back to Component Space.
-		FTransform BoneTransform = JointPoses[BoneToModify.BoneName];
-		FAnimationRuntime::ConvertBoneSpaceTransformToCS(ComponentTransform, Output.Pose,
-		                                                 BoneTransform,
-		                                                 CompactPoseBoneToModifyIndex,
-		                                                 BCS_BoneSpace);
+	// A joint pose is applied in the bone space of the joint. The transforms below a modified joint are
+	// recomputed from their local transforms in compact pose order, so that the pose is blended only once
+	// by the base node and every joint still sees the modified transforms of its parents.
+	ModifiedTransforms.SetNum(NumBones);
+	ModifiedBones.Init(false, NumBones);
+	for (int32 Index = BonesToModify[0].GetCompactPoseIndex(BoneContainer).GetInt(); Index < NumBones; ++Index)
+	{
+		const FCompactPoseBoneIndex BoneIndex(Index);
+		const FCompactPoseBoneIndex ParentBoneIndex = BoneContainer.GetParentBoneIndex(BoneIndex);
+		const bool bParentModified = ParentBoneIndex.IsValid() && ModifiedBones[ParentBoneIndex.GetInt()];
+		const FName& JointName = JointNames[Index];
+		const FTransform* JointPose = nullptr;
+		if (!JointName.IsNone() && JointState != nullptr)
+		{
+			const int32 JointIndex = JointStateIndices[Index];
+			JointPose = JointState->JointPoses.IsValidIndex(JointIndex) ? &JointState->JointPoses[JointIndex] : nullptr;
+		}
+		else if (!JointName.IsNone())
+		{
+			JointPose = JointPoses.Find(JointName);
+		}
+		if (JointPose == nullptr && !bParentModified)
+		{
+			continue;
+		}
 
-		OutBoneTransforms.Add(FBoneTransform(BoneToModify.GetCompactPoseIndex(BoneContainer),
-		                                     BoneTransform));
+		FTransform BoneTransform = bParentModified ? Output.Pose.GetLocalSpaceTransform(BoneIndex) * ModifiedTransforms[ParentBoneIndex.GetInt()]
+		                                           : Output.Pose.GetComponentSpaceTransform(BoneIndex);
+		if (JointPose != nullptr)
+		{
+			BoneTransform = *JointPose * BoneTransform;
+			OutBoneTransforms.Add(FBoneTransform(BoneIndex, BoneTransform));
+		}
 
-		Output.Pose.LocalBlendCSBoneTransforms(OutBoneTransforms, 1.f);
+		ModifiedTransforms[Index] = BoneTransform;
+		ModifiedBones[Index] = true;
 	}
 }
 
@@ -51,19 +93,26 @@ void FAnimNode_ModifyBones::InitializeBoneReferences(const FBoneContainer& Requi
 {
 	DECLARE_SCOPE_HIERARCHICAL_COUNTER_ANIMNODE(InitializeBoneReferences)
 
-	for (int32 BoneIndex = 0; BoneIndex < RequiredBones.GetNumBones(); ++BoneIndex)
+	// Rebuilt on every LOD change, bones that the LOD removes are left out
+	BonesToModify.Reset();
+	JointStateIndices.Reset();
+	JointNames.Init(NAME_None, RequiredBones.GetCompactPoseNumBones());
+	const TSharedPtr<const FMultiverseSkeletonJoints> SkeletonJoints = FMultiverseSkeletonJoints::Get(RequiredBones.GetSkeletonAsset());
+	if (!SkeletonJoints.IsValid())
 	{
-		if (FName BoneName = RequiredBones.GetReferenceSkeleton().GetBoneName(BoneIndex);
-			BoneName.ToString().EndsWith(TEXT("_continuous_bone"), ESearchCase::CaseSensitive) ||
-			BoneName.ToString().EndsWith(TEXT("_prismatic_bone"), ESearchCase::CaseSensitive) ||
-			BoneName.ToString().EndsWith(TEXT("_revolute_bone"), ESearchCase::CaseSensitive) ||
-			BoneName.ToString().EndsWith(TEXT("_ball_bone"), ESearchCase::CaseSensitive))
+		return;
+	}
+
+	for (const FMultiverseSkeletonJoint& Joint : SkeletonJoints->Joints)
+	{
+		if (FBoneReference BoneToModify(Joint.BoneName); BoneToModify.Initialize(RequiredBones) && BoneToModify.IsValidToEvaluate(RequiredBones))
 		{
-			if (FBoneReference BoneToModify(BoneName); !BonesToModify.Contains(BoneToModify))
-			{
-				BoneToModify.Initialize(RequiredBones);
-				BonesToModify.Add(BoneToModify);
-			}
+			JointNames[BoneToModify.GetCompactPoseIndex(RequiredBones).GetInt()] = Joint.BoneName;
+			BonesToModify.Add(BoneToModify);
 		}
 	}
+	BonesToModify.Sort([&RequiredBones](const FBoneReference& BoneA, const FBoneReference& BoneB)
+	{
+		return BoneA.GetCompactPoseIndex(RequiredBones).GetInt() < BoneB.GetCompactPoseIndex(RequiredBones).GetInt();
+	});
 }
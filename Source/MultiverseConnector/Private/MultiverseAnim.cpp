@@ -6,22 +6,88 @@ UMultiverseAnim::UMultiverseAnim()
 {
 }
 
+void UMultiverseAnim::NativeInitializeAnimation()
+{
+	InitJoints();
+}
+
 void UMultiverseAnim::NativeBeginPlay()
 {
-	TArray<FName> BoneNames;
-	GetSkelMeshComponent()->GetBoneNames(BoneNames);
-	for (const FName& BoneName : BoneNames)
+	InitJoints();
+}
+
+void UMultiverseAnim::NativeUpdateAnimation(float DeltaSeconds)
+{
+	PublishJointState();
+}
+
+void UMultiverseAnim::InitJoints()
+{
+	if (SkeletonJoints.IsValid())
 	{
-		if (BoneName.ToString().EndsWith(TEXT("continuous_bone"), ESearchCase::CaseSensitive) ||
-			BoneName.ToString().EndsWith(TEXT("prismatic_bone"), ESearchCase::CaseSensitive) ||
-			BoneName.ToString().EndsWith(TEXT("revolute_bone"), ESearchCase::CaseSensitive) ||
-			BoneName.ToString().EndsWith(TEXT("ball_bone"), ESearchCase::CaseSensitive))
-		{
-			JointPoses.Add(BoneName);
-		}
+		return;
+	}
+
+	SkeletonJoints = FMultiverseSkeletonJoints::Get(CurrentSkeleton);
+	if (!SkeletonJoints.IsValid())
+	{
+		return;
+	}
+
+	JointNames.Reset(SkeletonJoints->Joints.Num());
+	PendingJointPoses.Reset(SkeletonJoints->Joints.Num());
+	for (const FMultiverseSkeletonJoint& Joint : SkeletonJoints->Joints)
+	{
+		JointNames.Add(Joint.BoneName);
+		PendingJointPoses.Add(JointPoses.FindOrAdd(Joint.BoneName));
 	}
 }
 
-void UMultiverseAnim::NativeUpdateAnimation(float DeltaSeconds)
+const TArray<FName>& UMultiverseAnim::GetJointNames()
 {
+	check(IsInGameThread());
+	InitJoints();
+	return JointNames;
+}
+
+const FMultiverseSkeletonJoints* UMultiverseAnim::GetSkeletonJoints()
+{
+	check(IsInGameThread());
+	InitJoints();
+	return SkeletonJoints.Get();
+}
+
+int32 UMultiverseAnim::GetJointIndex(const FName& JointName)
+{
+	check(IsInGameThread());
+	InitJoints();
+	return FindJointIndex(JointName);
+}
+
+int32 UMultiverseAnim::FindJointIndex(const FName& JointName) const
+{
+	return SkeletonJoints.IsValid() ? SkeletonJoints->FindJoint(JointName) : INDEX_NONE;
+}
+
+void UMultiverseAnim::PublishJointState()
+{
+	if (!bJointStateDirty)
+	{
+		return;
+	}
+
+	FMultiverseJointState& JointState = JointStates.GetWriteBuffer();
+	JointState.JointPoses = PendingJointPoses;
+	JointState.Sequence = ++JointStateSequence;
+	JointStates.SwapWriteBuffers();
+	bJointStateDirty = false;
+}
+
+const FMultiverseJointState& UMultiverseAnim::ReadJointState()
+{
+	if (JointStates.IsDirty())
+	{
+		JointStates.SwapReadBuffers();
+	}
+	return JointStates.Read();
 }
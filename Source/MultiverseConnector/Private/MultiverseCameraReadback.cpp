@@ -0,0 +1,226 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#include "MultiverseCameraReadback.h"
+
+#include "Async/Async.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "RHIGPUReadback.h"
+#include "RenderingThread.h"
+#include "TextureResource.h"
+
+static bool IsFloatRenderTargetFormat(const ETextureRenderTargetFormat RenderTargetFormat)
+{
+	switch (RenderTargetFormat)
+	{
+	case ETextureRenderTargetFormat::RTF_R16f:
+	case ETextureRenderTargetFormat::RTF_RG16f:
+	case ETextureRenderTargetFormat::RTF_RGBA16f:
+	case ETextureRenderTargetFormat::RTF_R32f:
+	case ETextureRenderTargetFormat::RTF_RG32f:
+	case ETextureRenderTargetFormat::RTF_RGBA32f:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+FMultiverseCameraReadback::FMultiverseCameraReadback(int32 InRingSize, bool bInAsyncReadback)
+	: bAsyncReadback(bInAsyncReadback)
+{
+	const int32 RingSize = bAsyncReadback ? FMath::Max(InRingSize, 1) : 0;
+	for (int32 SlotIndex = 0; SlotIndex < RingSize; SlotIndex++)
+	{
+		TUniquePtr<FSlot> &Slot = Slots.Add_GetRef(MakeUnique<FSlot>());
+		Slot->Readback = MakeUnique<FRHIGPUTextureReadback>(TEXT("MultiverseCameraReadback"));
+	}
+}
+
+FMultiverseCameraReadback::~FMultiverseCameraReadback() = default;
+
+bool FMultiverseCameraReadback::IsSupported()
+{
+	return !GUsingNullRHI;
+}
+
+void FMultiverseCameraReadback::Update(UTextureRenderTarget2D *TextureTarget, double WorldTime, bool bCopy)
+{
+	check(IsInGameThread());
+
+	if (!bAsyncReadback)
+	{
+		if (!bCopy || !ReadPixels(TextureTarget, WorldTime, ReadPixelsFrame))
+		{
+			return;
+		}
+		if (FrameProcessor)
+		{
+			FrameProcessor(ReadPixelsFrame, LatestFrame);
+		}
+		else
+		{
+			Swap(LatestFrame, ReadPixelsFrame);
+		}
+		return;
+	}
+
+	// Pick up the newest completed frame, older completed frames are recycled without being sent
+	const ESlotState CompletedState = FrameProcessor ? ESlotState::Processed : ESlotState::Ready;
+	FSlot *NewestSlot = nullptr;
+	for (TUniquePtr<FSlot> &Slot : Slots)
+	{
+		if (Slot->State == CompletedState && Slot->Sequence > LatestSequence && (NewestSlot == nullptr || Slot->Sequence > NewestSlot->Sequence))
+		{
+			NewestSlot = Slot.Get();
+		}
+	}
+	if (NewestSlot != nullptr)
+	{
+		LatestSequence = NewestSlot->Sequence;
+		Swap(LatestFrame, FrameProcessor ? NewestSlot->ProcessedFrame : NewestSlot->Frame);
+	}
+	for (TUniquePtr<FSlot> &Slot : Slots)
+	{
+		if ((Slot->State == ESlotState::Ready || Slot->State == CompletedState) && Slot->Sequence <= LatestSequence)
+		{
+			Slot->State = ESlotState::Free;
+		}
+	}
+
+	if (FrameProcessor)
+	{
+		ProcessReadyFrame();
+	}
+
+	FTextureRenderTargetResource *TextureRenderTargetResource = TextureTarget != nullptr ? TextureTarget->GameThread_GetRenderTargetResource() : nullptr;
+	FSlot *CopySlot = Slots[NextSlot].Get();
+	if (!bCopy || TextureRenderTargetResource == nullptr || CopySlot->State != ESlotState::Free)
+	{
+		CopySlot = nullptr;
+	}
+	else
+	{
+		CopySlot->State = ESlotState::InFlight;
+		CopySlot->Sequence = NextSequence++;
+		CopySlot->Frame.WorldTime = WorldTime;
+		NextSlot = (NextSlot + 1) % Slots.Num();
+	}
+
+	// The command keeps this object alive until the rendering thread is done with it
+	ENQUEUE_RENDER_COMMAND(MultiverseCameraReadback)
+	([This = AsShared(), CopySlot, TextureRenderTargetResource](FRHICommandListImmediate &RHICmdList)
+	 {
+		if (CopySlot != nullptr)
+		{
+			FRHITexture *Texture = TextureRenderTargetResource->GetRenderTargetTexture();
+			const FIntVector Size = Texture->GetSizeXYZ();
+			CopySlot->Frame.Format = Texture->GetFormat();
+			CopySlot->Frame.Width = Size.X;
+			CopySlot->Frame.Height = Size.Y;
+			CopySlot->Readback->EnqueueCopy(RHICmdList, Texture);
+		}
+		This->PollReadbacks_RenderThread(); });
+}
+
+void FMultiverseCameraReadback::ProcessReadyFrame()
+{
+	FSlot *NewestSlot = nullptr;
+	for (TUniquePtr<FSlot> &Slot : Slots)
+	{
+		if (Slot->State == ESlotState::Ready && (NewestSlot == nullptr || Slot->Sequence > NewestSlot->Sequence))
+		{
+			NewestSlot = Slot.Get();
+		}
+	}
+	if (NewestSlot == nullptr)
+	{
+		return;
+	}
+
+	// Only the newest frame is worth processing, the older ones would be dropped anyway
+	for (TUniquePtr<FSlot> &Slot : Slots)
+	{
+		if (Slot->State == ESlotState::Ready && Slot.Get() != NewestSlot)
+		{
+			Slot->State = ESlotState::Free;
+		}
+	}
+
+	NewestSlot->State = ESlotState::Processing;
+	AsyncTask(ENamedThreads::AnyBackgroundThreadNormalTask, [This = AsShared(), NewestSlot]()
+			  {
+				  This->FrameProcessor(NewestSlot->Frame, NewestSlot->ProcessedFrame);
+				  NewestSlot->ProcessedFrame.WorldTime = NewestSlot->Frame.WorldTime;
+				  NewestSlot->State = ESlotState::Processed; });
+}
+
+void FMultiverseCameraReadback::PollReadbacks_RenderThread()
+{
+	for (TUniquePtr<FSlot> &Slot : Slots)
+	{
+		if (Slot->State != ESlotState::InFlight || !Slot->Readback->IsReady())
+		{
+			continue;
+		}
+
+		FMultiverseCameraFrame &Frame = Slot->Frame;
+		const int32 BytesPerPixel = GPixelFormats[Frame.Format].BlockBytes;
+		const int32 RowSize = Frame.Width * BytesPerPixel;
+		int32 RowPitchInPixels = 0;
+		const uint8 *Data = static_cast<const uint8 *>(Slot->Readback->Lock(RowPitchInPixels));
+		if (Data == nullptr)
+		{
+			Frame.Pixels.Reset();
+		}
+		else
+		{
+			Frame.Pixels.SetNumUninitialized(RowSize * Frame.Height);
+			for (int32 Row = 0; Row < Frame.Height; Row++)
+			{
+				FMemory::Memcpy(Frame.Pixels.GetData() + Row * RowSize, Data + Row * RowPitchInPixels * BytesPerPixel, RowSize);
+			}
+			Slot->Readback->Unlock();
+		}
+
+		Slot->State = ESlotState::Ready;
+	}
+}
+
+bool FMultiverseCameraReadback::ReadPixels(UTextureRenderTarget2D *TextureTarget, double WorldTime, FMultiverseCameraFrame &OutFrame)
+{
+	FTextureRenderTargetResource *TextureRenderTargetResource = TextureTarget != nullptr ? TextureTarget->GameThread_GetRenderTargetResource() : nullptr;
+	if (TextureRenderTargetResource == nullptr)
+	{
+		return false;
+	}
+
+	OutFrame.Width = TextureTarget->SizeX;
+	OutFrame.Height = TextureTarget->SizeY;
+	OutFrame.WorldTime = WorldTime;
+	if (IsFloatRenderTargetFormat(TextureTarget->RenderTargetFormat))
+	{
+		TArray<FLinearColor> LinearColorArray;
+		if (!TextureRenderTargetResource->ReadLinearColorPixels(LinearColorArray))
+		{
+			return false;
+		}
+
+		OutFrame.Format = PF_A32B32G32R32F;
+		OutFrame.Pixels.SetNumUninitialized(LinearColorArray.Num() * sizeof(FLinearColor));
+		FMemory::Memcpy(OutFrame.Pixels.GetData(), LinearColorArray.GetData(), OutFrame.Pixels.Num());
+		return true;
+	}
+
+	TArray<FColor> ColorArray;
+	FReadSurfaceDataFlags ReadSurfaceDataFlags;
+	ReadSurfaceDataFlags.SetLinearToGamma(false);
+	if (!TextureRenderTargetResource->ReadPixels(ColorArray, ReadSurfaceDataFlags))
+	{
+		return false;
+	}
+
+	OutFrame.Format = PF_B8G8R8A8;
+	OutFrame.Pixels.SetNumUninitialized(ColorArray.Num() * sizeof(FColor));
+	FMemory::Memcpy(OutFrame.Pixels.GetData(), ColorArray.GetData(), OutFrame.Pixels.Num());
+	return true;
+}
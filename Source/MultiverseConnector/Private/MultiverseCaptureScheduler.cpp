@@ -0,0 +1,58 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#include "MultiverseCaptureScheduler.h"
+
+void FMultiverseCaptureScheduler::Reset(int32 InMaxCapturesPerFrame)
+{
+	Cameras.Reset();
+	MaxCapturesPerFrame = FMath::Max(InMaxCapturesPerFrame, 0);
+	NextCamera = 0;
+}
+
+int32 FMultiverseCaptureScheduler::AddCamera(float CaptureRate)
+{
+	FCamera &Camera = Cameras.AddDefaulted_GetRef();
+	Camera.CaptureInterval = CaptureRate > 0.f ? 1.0 / CaptureRate : 0.0;
+	return Cameras.Num() - 1;
+}
+
+void FMultiverseCaptureScheduler::Schedule(double WorldTime, TArray<bool> &OutDueCameras)
+{
+	OutDueCameras.Init(false, Cameras.Num());
+	if (Cameras.Num() == 0)
+	{
+		return;
+	}
+
+	int32 CaptureNum = 0;
+	int32 LastCapturedCamera = INDEX_NONE;
+	for (int32 Offset = 0; Offset < Cameras.Num(); Offset++)
+	{
+		if (MaxCapturesPerFrame > 0 && CaptureNum >= MaxCapturesPerFrame)
+		{
+			break;
+		}
+
+		const int32 CameraIndex = (NextCamera + Offset) % Cameras.Num();
+		FCamera &Camera = Cameras[CameraIndex];
+		if (WorldTime < Camera.NextCaptureTime)
+		{
+			continue;
+		}
+
+		// A camera that fell behind is not captured several times in a row to catch up
+		Camera.NextCaptureTime += Camera.CaptureInterval;
+		if (Camera.NextCaptureTime <= WorldTime)
+		{
+			Camera.NextCaptureTime = WorldTime + Camera.CaptureInterval;
+		}
+		OutDueCameras[CameraIndex] = true;
+		LastCapturedCamera = CameraIndex;
+		CaptureNum++;
+	}
+
+	if (LastCapturedCamera != INDEX_NONE)
+	{
+		NextCamera = (LastCapturedCamera + 1) % Cameras.Num();
+	}
+}
@@ -3,12 +3,27 @@
 #include "MultiverseClient.h"
 
 #include "Animation/SkeletalMeshActor.h"
+#include "Async/ParallelFor.h"
+#include "Async/TaskGraphInterfaces.h"
 #include "Engine/StaticMeshActor.h"
+#include "HAL/IConsoleManager.h"
+#include "Hash/CityHash.h"
 #include "Json.h"
 #include "Math/UnrealMathUtility.h"
+#include "Misc/App.h"
+#include "Misc/ScopeLock.h"
 #include "MultiverseAnim.h"
+#include "MultiverseCameraReadback.h"
+#include "MultiverseImageEncoder.h"
+#include "MultiverseImageKernels.h"
 #include "MultiverseClient.h"
+#include "MultiverseCommunicationThread.h"
+#include "MultiversePhysicsStepCallback.h"
+#include "MultiverseSkeletonJoints.h"
+#include "PBDRigidsSolver.h"
+#include "Physics/Experimental/PhysScene_Chaos.h"
 #include "PhysicsEngine/PhysicsConstraintComponent.h"
+#include "PhysicsProxy/SingleParticlePhysicsProxy.h"
 #include "Components/SceneCaptureComponent2D.h"
 #include "Engine/TextureRenderTarget2D.h"
 #include "Camera/CameraComponent.h"
@@ -22,6 +37,12 @@
 
 DEFINE_LOG_CATEGORY_STATIC(LogMultiverseClient, Log, All);
 
+/** Server times closer than this are the same step in lockstep */
+static constexpr double LockstepTimeTolerance = 1e-9;
+
+/** Seconds between the round-trips of a frame that waits for the server to step */
+static constexpr float LockstepPollInterval = 0.001f;
+
 TMap<EAttribute, TArray<double>> AttributeDoubleDataMap =
 	{
 		{EAttribute::AngularVelocity, {0.0, 0.0, 0.0}},
@@ -48,20 +69,6 @@ TMap<EAttribute, TArray<double>> AttributeDoubleDataMap =
 		{EAttribute::Scalar, {0.0}},
 		{EAttribute::Torque, {0.0, 0.0, 0.0}}};
 
-TMap<EAttribute, TArray<uint8_t>> AttributeUint8DataMap =
-	{
-		{EAttribute::RGB_3840_2160, TArray<uint8_t>()},
-		{EAttribute::RGB_1280_1024, TArray<uint8_t>()},
-		{EAttribute::RGB_640_480, TArray<uint8_t>()},
-		{EAttribute::RGB_128_128, TArray<uint8_t>()}};
-
-TMap<EAttribute, TArray<uint16_t>> AttributeUint16DataMap =
-	{
-		{EAttribute::Depth_3840_2160, TArray<uint16_t>()},
-		{EAttribute::Depth_1280_1024, TArray<uint16_t>()},
-		{EAttribute::Depth_640_480, TArray<uint16_t>()},
-		{EAttribute::Depth_128_128, TArray<uint16_t>()}};
-
 const TMap<FString, EAttribute> AttributeStringMap =
 	{
 		{TEXT("angular_velocity"), EAttribute::AngularVelocity},
@@ -73,6 +80,7 @@ const TMap<FString, EAttribute> AttributeStringMap =
 		{TEXT("cmd_joint_linear_position"), EAttribute::CmdJointLinearPosition},
 		{TEXT("cmd_joint_linear_velocity"), EAttribute::CmdJointLinearVelocity},
 		{TEXT("cmd_joint_torque"), EAttribute::CmdJointTorque},
+		{TEXT("depth"), EAttribute::Depth},
 		{TEXT("depth_1280_1024"), EAttribute::Depth_1280_1024},
 		{TEXT("depth_128_128"), EAttribute::Depth_128_128},
 		{TEXT("depth_3840_2160"), EAttribute::Depth_3840_2160},
@@ -89,6 +97,7 @@ const TMap<FString, EAttribute> AttributeStringMap =
 		{TEXT("linear_velocity"), EAttribute::LinearVelocity},
 		{TEXT("position"), EAttribute::Position},
 		{TEXT("quaternion"), EAttribute::Quaternion},
+		{TEXT("rgb"), EAttribute::RGB},
 		{TEXT("rgb_1280_1024"), EAttribute::RGB_1280_1024},
 		{TEXT("rgb_128_128"), EAttribute::RGB_128_128},
 		{TEXT("rgb_3840_2160"), EAttribute::RGB_3840_2160},
@@ -96,21 +105,482 @@ const TMap<FString, EAttribute> AttributeStringMap =
 		{TEXT("scalar"), EAttribute::Scalar},
 		{TEXT("torque"), EAttribute::Torque}};
 
-UTextureRenderTarget2D *RenderTarget_RGBA8_3840_2160;
-UTextureRenderTarget2D *RenderTarget_RGBA8_1280_1024;
-UTextureRenderTarget2D *RenderTarget_RGBA8_640_480;
-UTextureRenderTarget2D *RenderTarget_RGBA8_128_128;
+static bool IsDepthAttribute(const EAttribute Attribute)
+{
+	return Attribute == EAttribute::Depth ||
+		   Attribute == EAttribute::Depth_3840_2160 ||
+		   Attribute == EAttribute::Depth_1280_1024 ||
+		   Attribute == EAttribute::Depth_640_480 ||
+		   Attribute == EAttribute::Depth_128_128;
+}
+
+static FMultiverseSensorDescriptor MakeSensorDescriptor(const int32 Width, const int32 Height, const bool bIsDepth)
+{
+	FMultiverseSensorDescriptor Sensor;
+	Sensor.Width = Width;
+	Sensor.Height = Height;
+	Sensor.Format = bIsDepth ? ETextureRenderTargetFormat::RTF_R32f : ETextureRenderTargetFormat::RTF_RGBA8;
+	Sensor.CaptureSource = bIsDepth ? ESceneCaptureSource::SCS_SceneDepth : ESceneCaptureSource::SCS_SceneColorHDR;
+	return Sensor;
+}
+
+/** The fixed camera attributes, RGB and Depth take their descriptor from the attribute container */
+const TMap<EAttribute, FMultiverseSensorDescriptor> AttributeSensorMap =
+	{
+		{EAttribute::Depth_1280_1024, MakeSensorDescriptor(1280, 1024, true)},
+		{EAttribute::Depth_128_128, MakeSensorDescriptor(128, 128, true)},
+		{EAttribute::Depth_3840_2160, MakeSensorDescriptor(3840, 2160, true)},
+		{EAttribute::Depth_640_480, MakeSensorDescriptor(640, 480, true)},
+		{EAttribute::RGB_1280_1024, MakeSensorDescriptor(1280, 1024, false)},
+		{EAttribute::RGB_128_128, MakeSensorDescriptor(128, 128, false)},
+		{EAttribute::RGB_3840_2160, MakeSensorDescriptor(3840, 2160, false)},
+		{EAttribute::RGB_640_480, MakeSensorDescriptor(640, 480, false)}};
+
+static bool IsSensorAttribute(const EAttribute Attribute)
+{
+	return Attribute == EAttribute::RGB || Attribute == EAttribute::Depth || AttributeSensorMap.Contains(Attribute);
+}
+
+static FMultiverseSensorDescriptor GetSensorDescriptor(const EAttribute Attribute, const FAttributeContainer *AttributeContainer)
+{
+	if (const FMultiverseSensorDescriptor *Sensor = AttributeSensorMap.Find(Attribute))
+	{
+		return *Sensor;
+	}
+	if (const FMultiverseSensorDescriptor *Sensor = AttributeContainer != nullptr ? AttributeContainer->Sensors.Find(Attribute) : nullptr)
+	{
+		FMultiverseSensorDescriptor AttributeSensor = *Sensor;
+		if (!Sensor->bOverrideFormat)
+		{
+			const FMultiverseSensorDescriptor DefaultSensor = MakeSensorDescriptor(Sensor->Width, Sensor->Height, IsDepthAttribute(Attribute));
+			AttributeSensor.Format = DefaultSensor.Format;
+			AttributeSensor.CaptureSource = DefaultSensor.CaptureSource;
+		}
+		return AttributeSensor;
+	}
+	return MakeSensorDescriptor(640, 480, IsDepthAttribute(Attribute));
+}
+
+/** Whether the readback of the render target can be sent as the image of the attribute */
+static bool IsSensorFormatSupported(const EAttribute Attribute, const FMultiverseSensorDescriptor &Sensor)
+{
+	const bool bIsDepthSource = Sensor.CaptureSource == ESceneCaptureSource::SCS_SceneDepth || Sensor.CaptureSource == ESceneCaptureSource::SCS_DeviceDepth;
+	if (IsDepthAttribute(Attribute) != bIsDepthSource)
+	{
+		return false;
+	}
+
+	switch (Sensor.Format)
+	{
+	case ETextureRenderTargetFormat::RTF_R16f:
+	case ETextureRenderTargetFormat::RTF_R32f:
+		return IsDepthAttribute(Attribute);
+
+	case ETextureRenderTargetFormat::RTF_RGBA8:
+	case ETextureRenderTargetFormat::RTF_RGBA8_SRGB:
+		return !IsDepthAttribute(Attribute);
+
+	case ETextureRenderTargetFormat::RTF_RGBA16f:
+	case ETextureRenderTargetFormat::RTF_RGBA32f:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+static FString GetSensorAttributeName(const EAttribute Attribute, const FMultiverseSensorDescriptor &Sensor)
+{
+	return FString::Printf(TEXT("%s_%d_%d"), IsDepthAttribute(Attribute) ? TEXT("depth") : TEXT("rgb"), Sensor.Width, Sensor.Height);
+}
+
+/** Buffer type and number of values of an attribute by its name in the meta data */
+static bool GetAttributeBufferSize(const FString &AttributeName, FString &OutBufferType, int32 &OutBufferSize)
+{
+	if (const EAttribute *Attribute = AttributeStringMap.Find(AttributeName))
+	{
+		if (const TArray<double> *AttributeDoubleData = AttributeDoubleDataMap.Find(*Attribute))
+		{
+			OutBufferType = TEXT("double");
+			OutBufferSize = AttributeDoubleData->Num();
+			return true;
+		}
+	}
+
+	// Camera attributes are named after their resolution, e.g. rgb_640_480
+	TArray<FString> Tokens;
+	AttributeName.ParseIntoArray(Tokens, TEXT("_"));
+	if (Tokens.Num() != 3 || (Tokens[0] != TEXT("rgb") && Tokens[0] != TEXT("depth")) || !Tokens[1].IsNumeric() || !Tokens[2].IsNumeric())
+	{
+		return false;
+	}
+
+	const int32 PixelNum = FCString::Atoi(*Tokens[1]) * FCString::Atoi(*Tokens[2]);
+	OutBufferType = Tokens[0] == TEXT("rgb") ? TEXT("uint8") : TEXT("uint16");
+	OutBufferSize = Tokens[0] == TEXT("rgb") ? PixelNum * 3 : PixelNum;
+	return true;
+}
+
+/** Buffer values of an image slot, an encoded image gets the worst case of its encoding or a fraction of the raw size after its header */
+static int32 GetImageSlotSize(const int32 RawSize, const int32 ValueSize, const FMultiverseClientSettings &Settings)
+{
+	if (Settings.ImageEncoding == EMultiverseImageEncoding::None)
+	{
+		return RawSize;
+	}
+
+	const int32 RawBytes = RawSize * ValueSize;
+	const int32 BytesPerPixel = ValueSize == sizeof(uint16) ? sizeof(uint16) : 3;
+	const int32 EncodedBytes = Settings.ImageCompressionRatio > 0 && Settings.ImageEncoding != EMultiverseImageEncoding::Raw
+								   ? FMath::DivideAndRoundUp(RawBytes, Settings.ImageCompressionRatio)
+								   : MultiverseImageEncoder::GetMaxEncodedSize(Settings.ImageEncoding, RawBytes, BytesPerPixel);
+	return FMath::DivideAndRoundUp(MultiverseImageEncoder::HeaderSize + EncodedBytes, ValueSize);
+}
+
+/** Build the JSON value starting at Notation, for the small parts of the response meta data */
+static TSharedPtr<FJsonValue> ReadJsonValue(TJsonReader<> &Reader, EJsonNotation Notation)
+{
+	switch (Notation)
+	{
+	case EJsonNotation::ObjectStart:
+	{
+		TSharedPtr<FJsonObject> Object = MakeShareable(new FJsonObject);
+		while (Reader.ReadNext(Notation) && Notation != EJsonNotation::ObjectEnd)
+		{
+			const FString Identifier = Reader.GetIdentifier();
+			TSharedPtr<FJsonValue> Value = ReadJsonValue(Reader, Notation);
+			if (!Value.IsValid())
+			{
+				return nullptr;
+			}
+			Object->SetField(Identifier, Value);
+		}
+		if (Notation != EJsonNotation::ObjectEnd)
+		{
+			return nullptr;
+		}
+		return MakeShareable(new FJsonValueObject(Object));
+	}
+
+	case EJsonNotation::ArrayStart:
+	{
+		TArray<TSharedPtr<FJsonValue>> Array;
+		while (Reader.ReadNext(Notation) && Notation != EJsonNotation::ArrayEnd)
+		{
+			TSharedPtr<FJsonValue> Value = ReadJsonValue(Reader, Notation);
+			if (!Value.IsValid())
+			{
+				return nullptr;
+			}
+			Array.Add(Value);
+		}
+		if (Notation != EJsonNotation::ArrayEnd)
+		{
+			return nullptr;
+		}
+		return MakeShareable(new FJsonValueArray(Array));
+	}
+
+	case EJsonNotation::Boolean:
+		return MakeShareable(new FJsonValueBoolean(Reader.GetValueAsBoolean()));
+
+	case EJsonNotation::String:
+		return MakeShareable(new FJsonValueString(Reader.GetValueAsString()));
+
+	case EJsonNotation::Number:
+		return MakeShareable(new FJsonValueNumber(Reader.GetValueAsNumber()));
+
+	case EJsonNotation::Null:
+		return MakeShareable(new FJsonValueNull());
+
+	default:
+		return nullptr;
+	}
+}
+
+/** Read {"object": {"attribute": [values], ...}, ...} after its ObjectStart, the values go straight into Data */
+static bool ReadResponseData(TJsonReader<> &Reader, FMultiverseResponseData &Data)
+{
+	EJsonNotation Notation = EJsonNotation::Error;
+	while (Reader.ReadNext(Notation) && Notation != EJsonNotation::ObjectEnd)
+	{
+		if (Notation != EJsonNotation::ObjectStart)
+		{
+			return false;
+		}
+
+		const int32 ObjectIndex = Data.ObjectNames.Add(Reader.GetIdentifier());
+		while (Reader.ReadNext(Notation) && Notation != EJsonNotation::ObjectEnd)
+		{
+			if (Notation != EJsonNotation::ArrayStart)
+			{
+				return false;
+			}
+
+			const FString &AttributeName = Reader.GetIdentifier();
+			const EAttribute *Attribute = AttributeStringMap.Find(AttributeName);
+			const bool bKeepValues = Attribute != nullptr && AttributeDoubleDataMap.Contains(*Attribute);
+			FString BufferType;
+			int32 BufferSize = 0;
+			const bool bHasBuffer = GetAttributeBufferSize(AttributeName, BufferType, BufferSize);
+
+			const int32 ValueOffset = Data.Values.Num();
+			int32 ValueNum = 0;
+			while (Reader.ReadNext(Notation) && Notation != EJsonNotation::ArrayEnd)
+			{
+				if (Notation != EJsonNotation::Number && Notation != EJsonNotation::Null)
+				{
+					return false;
+				}
+				if (bKeepValues)
+				{
+					Data.Values.Add(Notation == EJsonNotation::Number ? Reader.GetValueAsNumber() : 0.0);
+				}
+				ValueNum++;
+			}
+			if (Notation != EJsonNotation::ArrayEnd)
+			{
+				return false;
+			}
+
+			if (bKeepValues)
+			{
+				Data.Attributes.Add({ObjectIndex, *Attribute, ValueOffset, ValueNum});
+			}
+			if (bHasBuffer)
+			{
+				size_t &BufferNum = BufferType == TEXT("double") ? Data.DoubleNum : BufferType == TEXT("uint8") ? Data.Uint8Num : Data.Uint16Num;
+				BufferNum += ValueNum;
+			}
+		}
+		if (Notation != EJsonNotation::ObjectEnd)
+		{
+			return false;
+		}
+	}
+	return Notation == EJsonNotation::ObjectEnd;
+}
+
+/** Single pass over the response meta data, send and receive are read into flat arrays instead of JSON objects */
+static bool ReadResponseMetaData(TJsonReader<> &Reader, const TSharedPtr<FJsonObject> &ResponseMetaDataJson, FMultiverseResponseData &SendData, FMultiverseResponseData &ReceiveData)
+{
+	EJsonNotation Notation = EJsonNotation::Error;
+	if (!Reader.ReadNext(Notation) || Notation != EJsonNotation::ObjectStart)
+	{
+		return false;
+	}
+
+	while (Reader.ReadNext(Notation) && Notation != EJsonNotation::ObjectEnd)
+	{
+		const FString Identifier = Reader.GetIdentifier();
+		if (Notation == EJsonNotation::ObjectStart && (Identifier == TEXT("send") || Identifier == TEXT("receive")))
+		{
+			if (!ReadResponseData(Reader, Identifier == TEXT("send") ? SendData : ReceiveData))
+			{
+				return false;
+			}
+			continue;
+		}
+
+		TSharedPtr<FJsonValue> Value = ReadJsonValue(Reader, Notation);
+		if (!Value.IsValid())
+		{
+			return false;
+		}
+		ResponseMetaDataJson->SetField(Identifier, Value);
+	}
+	return Notation == EJsonNotation::ObjectEnd;
+}
+
+static void WriteVector(double *Addr, const FVector &Vector)
+{
+	Addr[0] = Vector.X;
+	Addr[1] = Vector.Y;
+	Addr[2] = Vector.Z;
+}
+
+static void WriteQuat(double *Addr, const FQuat &Quat)
+{
+	Addr[0] = Quat.W;
+	Addr[1] = Quat.X;
+	Addr[2] = Quat.Y;
+	Addr[3] = Quat.Z;
+}
+
+static FVector ReadVector(const double *Addr)
+{
+	return FVector(Addr[0], Addr[1], Addr[2]);
+}
+
+static FQuat ReadQuat(const double *Addr)
+{
+	return FQuat(Addr[1], Addr[2], Addr[3], Addr[0]);
+}
+
+static bool CanGatherInParallel(const FMultiverseBinding &Binding)
+{
+	// Only transforms of actors and scene components are plain reads, physics bodies, skeletal poses and hand tracking are not thread safe
+	switch (Binding.Type)
+	{
+	case EMultiverseBindingType::CustomObject:
+	case EMultiverseBindingType::SceneComponent:
+		return true;
+
+	case EMultiverseBindingType::Actor:
+		return Binding.Attribute == EAttribute::Position || Binding.Attribute == EAttribute::Quaternion;
+
+	default:
+		return false;
+	}
+}
+
+/** Convert the red channel of a depth frame to uint16 depth (PF_G16) */
+static void ConvertDepthFrame(const FMultiverseCameraFrame &Frame, FMultiverseCameraFrame &OutFrame, const FMultiverseDepthConversion &DepthConversion)
+{
+	const int32 PixelNum = Frame.Width * Frame.Height;
+	OutFrame.Format = PF_G16;
+	OutFrame.Width = Frame.Width;
+	OutFrame.Height = Frame.Height;
+	OutFrame.WorldTime = Frame.WorldTime;
+	OutFrame.Pixels.SetNumUninitialized(PixelNum * sizeof(uint16));
+	uint16 *OutDepth = reinterpret_cast<uint16 *>(OutFrame.Pixels.GetData());
+	switch (Frame.Format)
+	{
+	case PF_R32_FLOAT:
+		MultiverseImageKernels::ConvertDepthToUint16(reinterpret_cast<const float *>(Frame.Pixels.GetData()), 1, PixelNum, DepthConversion, OutDepth);
+		break;
+
+	case PF_A32B32G32R32F:
+		MultiverseImageKernels::ConvertDepthToUint16(reinterpret_cast<const float *>(Frame.Pixels.GetData()), 4, PixelNum, DepthConversion, OutDepth);
+		break;
+
+	case PF_R16F:
+		MultiverseImageKernels::ConvertDepthToUint16(reinterpret_cast<const FFloat16 *>(Frame.Pixels.GetData()), 1, PixelNum, DepthConversion, OutDepth);
+		break;
+
+	case PF_FloatRGBA:
+		MultiverseImageKernels::ConvertDepthToUint16(reinterpret_cast<const FFloat16 *>(Frame.Pixels.GetData()), 4, PixelNum, DepthConversion, OutDepth);
+		break;
+
+	default:
+		UE_LOG(LogMultiverseClient, Warning, TEXT("Pixel format %s of the depth readback is not supported"), GetPixelFormatString(Frame.Format))
+		OutFrame.Pixels.Reset();
+		break;
+	}
+}
+
+/** Pack a color frame as tightly packed RGB, false if its format is not a color format */
+static bool PackCameraFrameRGB(const FMultiverseCameraFrame &Frame, uint8_t *Uint8Addr)
+{
+	const int32 PixelNum = Frame.Width * Frame.Height;
+	switch (Frame.Format)
+	{
+	case PF_B8G8R8A8:
+	case PF_R8G8B8A8:
+		MultiverseImageKernels::PackRGB(Frame.Pixels.GetData(), Frame.Format == PF_B8G8R8A8, PixelNum, Uint8Addr);
+		return true;
+
+	case PF_FloatRGBA:
+	case PF_A32B32G32R32F:
+	{
+		for (int32 PixelIndex = 0; PixelIndex < PixelNum; PixelIndex++)
+		{
+			const FLinearColor LinearColor = Frame.Format == PF_FloatRGBA ? FLinearColor(reinterpret_cast<const FFloat16Color *>(Frame.Pixels.GetData())[PixelIndex]) : reinterpret_cast<const FLinearColor *>(Frame.Pixels.GetData())[PixelIndex];
+			const FColor Color = LinearColor.ToFColor(false);
+			*Uint8Addr++ = Color.R;
+			*Uint8Addr++ = Color.G;
+			*Uint8Addr++ = Color.B;
+		}
+		return true;
+	}
+
+	default:
+		return false;
+	}
+}
+
+/** Pack an RGB frame or a converted depth frame and encode it, runs on a worker thread */
+static void EncodeCameraFrame(const FMultiverseCameraFrame &Frame, FMultiverseCameraFrame &OutFrame, EMultiverseImageEncoding Encoding, int32 Quality)
+{
+	OutFrame.Format = Frame.Format;
+	OutFrame.Encoding = Encoding;
+	OutFrame.Width = Frame.Width;
+	OutFrame.Height = Frame.Height;
+	OutFrame.WorldTime = Frame.WorldTime;
+	if (Frame.Pixels.Num() == 0)
+	{
+		OutFrame.Pixels.Reset();
+		return;
+	}
+
+	const bool bIsDepth = Frame.Format == PF_G16;
+	const uint8 *Data = Frame.Pixels.GetData();
+	TArray<uint8> RGB;
+	if (!bIsDepth)
+	{
+		RGB.SetNumUninitialized(Frame.Width * Frame.Height * 3);
+		if (!PackCameraFrameRGB(Frame, RGB.GetData()))
+		{
+			UE_LOG(LogMultiverseClient, Warning, TEXT("Pixel format %s of the camera readback is not supported"), GetPixelFormatString(Frame.Format))
+			OutFrame.Pixels.Reset();
+			return;
+		}
+		Data = RGB.GetData();
+	}
+
+	if (!MultiverseImageEncoder::Encode(Encoding, Data, Frame.Width, Frame.Height, bIsDepth ? sizeof(uint16) : 3, Quality, OutFrame.Pixels))
+	{
+		UE_LOG(LogMultiverseClient, Warning, TEXT("Failed to encode a %dx%d image as %s"), Frame.Width, Frame.Height, MultiverseImageEncoder::GetEncodingName(Encoding))
+		OutFrame.Pixels.Reset();
+	}
+}
+
+/** Write a frame as tightly packed RGB, as uint16 depth once converted, or as the header and bytes of the encoded image */
+static void WriteCameraFrame(const FMultiverseCameraFrame &Frame, uint8_t *Uint8Addr, uint16_t *Uint16Addr, const int32 ImageSlotSize)
+{
+	const int32 PixelNum = Frame.Width * Frame.Height;
+	if (Frame.Encoding != EMultiverseImageEncoding::None)
+	{
+		uint8 *Slot = Uint8Addr != nullptr ? Uint8Addr : reinterpret_cast<uint8 *>(Uint16Addr);
+		const int32 SlotSize = Uint8Addr != nullptr ? ImageSlotSize : ImageSlotSize * sizeof(uint16_t);
+		if (!MultiverseImageEncoder::WriteToSlot(Frame.Pixels, Frame.WorldTime, Slot, SlotSize))
+		{
+			UE_LOG(LogMultiverseClient, Warning, TEXT("Encoded image of %d bytes does not fit into its slot of %d bytes, lower ImageCompressionRatio or set it to 0"), Frame.Pixels.Num(), SlotSize)
+		}
+		return;
+	}
+
+	if (Frame.Format == PF_G16)
+	{
+		if (Uint16Addr != nullptr)
+		{
+			FMemory::Memcpy(Uint16Addr, Frame.Pixels.GetData(), PixelNum * sizeof(uint16_t));
+		}
+		return;
+	}
+
+	if (Uint8Addr != nullptr && !PackCameraFrameRGB(Frame, Uint8Addr))
+	{
+		UE_LOG(LogMultiverseClient, Warning, TEXT("Pixel format %s of the camera readback is not supported"), GetPixelFormatString(Frame.Format))
+	}
+}
 
-UTextureRenderTarget2D *RenderTarget_R16_3840_2160;
-UTextureRenderTarget2D *RenderTarget_R16_1280_1024;
-UTextureRenderTarget2D *RenderTarget_R16_640_480;
-UTextureRenderTarget2D *RenderTarget_R16_128_128;
+static UTextureRenderTarget2D *CreateRenderTarget(UObject *Outer, const FString &AttributeName, const FMultiverseSensorDescriptor &Sensor)
+{
+	UTextureRenderTarget2D *TextureTarget = NewObject<UTextureRenderTarget2D>(Outer, MakeUniqueObjectName(Outer, UTextureRenderTarget2D::StaticClass(), *AttributeName));
+	TextureTarget->RenderTargetFormat = Sensor.Format;
+	TextureTarget->ClearColor = FLinearColor::Black;
+	TextureTarget->InitAutoFormat(Sensor.Width, Sensor.Height);
+	TextureTarget->UpdateResourceImmediate(true);
+	return TextureTarget;
+}
 
 static void BindMetaData(const TSharedPtr<FJsonObject> &MetaDataJson,
 						 const TPair<AActor *, FAttributeContainer> &Object,
 						 TMap<FString, AActor *> &CachedActors,
 						 TMap<FString, UActorComponent *> &CachedComponents,
-						 TMap<FString, TMap<UMultiverseAnim *, FName>> &CachedBoneNames)
+						 TMap<FString, TMap<UMultiverseAnim *, FName>> &CachedBoneNames,
+						 TArray<TPair<TWeakObjectPtr<USceneCaptureComponent2D>, FName>> &BoundSceneCaptureComponents)
 {
 	TArray<TSharedPtr<FJsonValue>> AttributeJsonArray;
 	if (Object.Key != nullptr)
@@ -129,85 +599,44 @@ static void BindMetaData(const TSharedPtr<FJsonObject> &MetaDataJson,
 				AttributeJsonArray.Add(MakeShareable(new FJsonValueString(AttributeName)));
 				break;
 
+			case EAttribute::RGB:
 			case EAttribute::RGB_3840_2160:
 			case EAttribute::RGB_1280_1024:
 			case EAttribute::RGB_640_480:
 			case EAttribute::RGB_128_128:
+			case EAttribute::Depth:
 			case EAttribute::Depth_3840_2160:
 			case EAttribute::Depth_1280_1024:
 			case EAttribute::Depth_640_480:
 			case EAttribute::Depth_128_128:
 			{
+				const FMultiverseSensorDescriptor Sensor = GetSensorDescriptor(Attribute, &Object.Value);
+				const FString SensorAttributeName = GetSensorAttributeName(Attribute, Sensor);
+				if (!IsSensorFormatSupported(Attribute, Sensor))
+				{
+					// Still bound to keep the buffer layout, its slot stays empty
+					UE_LOG(LogMultiverseClient, Error, TEXT("%s of %s cannot be captured as %s with capture source %s, override the format with a matching one"),
+						   *SensorAttributeName, *Object.Value.ObjectName, *UEnum::GetValueAsString(Sensor.Format.GetValue()), *UEnum::GetValueAsString(Sensor.CaptureSource.GetValue()))
+				}
 				TArray<USceneCaptureComponent2D *> SceneCaptureComponents;
 				Object.Key->GetComponents(SceneCaptureComponents);
 				for (USceneCaptureComponent2D *SceneCaptureComponent : SceneCaptureComponents)
 				{
-					if (SceneCaptureComponent->TextureTarget != nullptr)
-					{
-						continue;
-					}
-					AttributeJsonArray.Add(MakeShareable(new FJsonValueString(AttributeName)));
-					SceneCaptureComponent->ComponentTags.Add(*AttributeName);
-					if (Attribute == EAttribute::RGB_3840_2160 || Attribute == EAttribute::Depth_3840_2160)
-					{
-						if (Attribute == EAttribute::RGB_3840_2160)
-						{
-							SceneCaptureComponent->TextureTarget = DuplicateObject(RenderTarget_RGBA8_3840_2160, Object.Key, *AttributeName);
-							SceneCaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneColorHDR;
-							SceneCaptureComponent->TextureTarget->RenderTargetFormat = ETextureRenderTargetFormat::RTF_RGBA8;
-						}
-						else if (Attribute == EAttribute::Depth_3840_2160)
-						{
-							SceneCaptureComponent->TextureTarget = DuplicateObject(RenderTarget_R16_3840_2160, Object.Key, *AttributeName);
-							SceneCaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneDepth;
-							SceneCaptureComponent->TextureTarget->RenderTargetFormat = ETextureRenderTargetFormat::RTF_RGBA16f;
-						}
-					}
-					else if (Attribute == EAttribute::RGB_1280_1024 || Attribute == EAttribute::Depth_1280_1024)
-					{
-						if (Attribute == EAttribute::RGB_1280_1024)
-						{
-							SceneCaptureComponent->TextureTarget = DuplicateObject(RenderTarget_RGBA8_1280_1024, Object.Key, *AttributeName);
-							SceneCaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneColorHDR;
-							SceneCaptureComponent->TextureTarget->RenderTargetFormat = ETextureRenderTargetFormat::RTF_RGBA8;
-						}
-						else if (Attribute == EAttribute::Depth_1280_1024)
-						{
-							SceneCaptureComponent->TextureTarget = DuplicateObject(RenderTarget_R16_1280_1024, Object.Key, *AttributeName);
-							SceneCaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneDepth;
-							SceneCaptureComponent->TextureTarget->RenderTargetFormat = ETextureRenderTargetFormat::RTF_RGBA16f;
-						}
-					}
-					else if (Attribute == EAttribute::RGB_640_480 || Attribute == EAttribute::Depth_640_480)
+					if (SceneCaptureComponent->ComponentTags.Contains(*SensorAttributeName))
 					{
-						if (Attribute == EAttribute::RGB_640_480)
-						{
-							SceneCaptureComponent->TextureTarget = DuplicateObject(RenderTarget_RGBA8_640_480, Object.Key, *AttributeName);
-							SceneCaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneColorHDR;
-							SceneCaptureComponent->TextureTarget->RenderTargetFormat = ETextureRenderTargetFormat::RTF_RGBA8;
-						}
-						else if (Attribute == EAttribute::Depth_640_480)
-						{
-							SceneCaptureComponent->TextureTarget = DuplicateObject(RenderTarget_R16_640_480, Object.Key, *AttributeName);
-							SceneCaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneDepth;
-							SceneCaptureComponent->TextureTarget->RenderTargetFormat = ETextureRenderTargetFormat::RTF_RGBA16f;
-						}
+						// Bound again after a new meta data exchange, keep the render target
+						AttributeJsonArray.Add(MakeShareable(new FJsonValueString(SensorAttributeName)));
+						break;
 					}
-					else if (Attribute == EAttribute::RGB_128_128 || Attribute == EAttribute::Depth_128_128)
+					if (SceneCaptureComponent->TextureTarget != nullptr)
 					{
-						if (Attribute == EAttribute::RGB_128_128)
-						{
-							SceneCaptureComponent->TextureTarget = DuplicateObject(RenderTarget_RGBA8_128_128, Object.Key, *AttributeName);
-							SceneCaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneColorHDR;
-							SceneCaptureComponent->TextureTarget->RenderTargetFormat = ETextureRenderTargetFormat::RTF_RGBA8;
-						}
-						else if (Attribute == EAttribute::Depth_128_128)
-						{
-							SceneCaptureComponent->TextureTarget = DuplicateObject(RenderTarget_R16_128_128, Object.Key, *AttributeName);
-							SceneCaptureComponent->CaptureSource = ESceneCaptureSource::SCS_SceneDepth;
-							SceneCaptureComponent->TextureTarget->RenderTargetFormat = ETextureRenderTargetFormat::RTF_RGBA16f;
-						}
+						continue;
 					}
+					AttributeJsonArray.Add(MakeShareable(new FJsonValueString(SensorAttributeName)));
+					SceneCaptureComponent->ComponentTags.Add(*SensorAttributeName);
+					SceneCaptureComponent->TextureTarget = CreateRenderTarget(Object.Key, SensorAttributeName, Sensor);
+					SceneCaptureComponent->CaptureSource = Sensor.CaptureSource;
+					BoundSceneCaptureComponents.Emplace(SceneCaptureComponent, *SensorAttributeName);
 					break;
 				}
 				break;
@@ -229,37 +658,49 @@ static void BindMetaData(const TSharedPtr<FJsonObject> &MetaDataJson,
 		{
 			if (UMultiverseAnim *MultiverseAnim = Cast<UMultiverseAnim>(SkeletalMeshComponent->GetAnimInstance()))
 			{
-				TArray<FName> BoneNames;
-				SkeletalMeshComponent->GetBoneNames(BoneNames);
-				BoneNames.Sort([](const FName &BoneNameA, const FName &BoneNameB)
-							   { return BoneNameB.ToString().Compare(BoneNameA.ToString()) > 0; });
-				for (const FName &BoneName : BoneNames)
+				const FMultiverseSkeletonJoints *SkeletonJoints = MultiverseAnim->GetSkeletonJoints();
+				for (int32 JointIndex = 0; SkeletonJoints != nullptr && JointIndex < SkeletonJoints->Joints.Num(); JointIndex++)
 				{
-					FString BoneNameStr = BoneName.ToString();
-					if (((BoneNameStr.EndsWith(TEXT("_revolute_bone")) && BoneNameStr.RemoveFromEnd(TEXT("_revolute_bone"))) ||
-						 (BoneNameStr.EndsWith(TEXT("_continuous_bone")) && BoneNameStr.RemoveFromEnd(TEXT("_continuous_bone")))) &&
+					const FMultiverseSkeletonJoint &Joint = SkeletonJoints->Joints[JointIndex];
+					if (SkeletalMeshComponent->GetBoneIndex(Joint.BoneName) == INDEX_NONE)
+					{
+						continue;
+					}
+
+					if ((Joint.Type == EMultiverseJointType::Revolute || Joint.Type == EMultiverseJointType::Continuous) &&
 						Object.Value.Attributes.Contains(EAttribute::JointAngularPosition))
 					{
-						BoneNameStr = Object.Value.ObjectPrefix + BoneNameStr + Object.Value.ObjectSuffix;
+						const FString BoneNameStr = Object.Value.ObjectPrefix + Joint.JointName + Object.Value.ObjectSuffix;
 						AttributeJsonArray = {MakeShareable(new FJsonValueString(TEXT("joint_angular_position")))};
-						if (!CachedBoneNames.Contains(BoneNameStr))
-						{
-							CachedBoneNames.Add(BoneNameStr, TMap<UMultiverseAnim *, FName>());
-						}
-						CachedBoneNames[BoneNameStr].Add(MultiverseAnim, BoneName);
+						CachedBoneNames.FindOrAdd(BoneNameStr).Add(MultiverseAnim, Joint.BoneName);
 						MetaDataJson->SetArrayField(BoneNameStr, AttributeJsonArray);
 					}
-					else if ((BoneNameStr.EndsWith(TEXT("_prismatic_bone")) && BoneNameStr.RemoveFromEnd(TEXT("_prismatic_bone"))) &&
+					else if (Joint.Type == EMultiverseJointType::Prismatic &&
 							 Object.Value.Attributes.Contains(EAttribute::JointLinearPosition))
 					{
-						BoneNameStr = Object.Value.ObjectPrefix + BoneNameStr + Object.Value.ObjectSuffix;
+						const FString BoneNameStr = Object.Value.ObjectPrefix + Joint.JointName + Object.Value.ObjectSuffix;
 						AttributeJsonArray = {MakeShareable(new FJsonValueString(TEXT("joint_linear_position")))};
-						if (!CachedBoneNames.Contains(BoneNameStr))
+						CachedBoneNames.FindOrAdd(BoneNameStr).Add(MultiverseAnim, Joint.BoneName);
+						MetaDataJson->SetArrayField(BoneNameStr, AttributeJsonArray);
+					}
+					else if (Joint.Type == EMultiverseJointType::Ball || Joint.Type == EMultiverseJointType::Free)
+					{
+						// Ball and free joints are streamed as one block per joint instead of a scalar per axis
+						AttributeJsonArray.Reset();
+						if (Joint.Type == EMultiverseJointType::Free && Object.Value.Attributes.Contains(EAttribute::JointPosition))
 						{
-							CachedBoneNames.Add(BoneNameStr, TMap<UMultiverseAnim *, FName>());
+							AttributeJsonArray.Add(MakeShareable(new FJsonValueString(TEXT("joint_position"))));
+						}
+						if (Object.Value.Attributes.Contains(EAttribute::JointQuaternion))
+						{
+							AttributeJsonArray.Add(MakeShareable(new FJsonValueString(TEXT("joint_quaternion"))));
+						}
+						if (AttributeJsonArray.Num() > 0)
+						{
+							const FString BoneNameStr = Object.Value.ObjectPrefix + Joint.JointName + Object.Value.ObjectSuffix;
+							CachedBoneNames.FindOrAdd(BoneNameStr).Add(MultiverseAnim, Joint.BoneName);
+							MetaDataJson->SetArrayField(BoneNameStr, AttributeJsonArray);
 						}
-						CachedBoneNames[BoneNameStr].Add(MultiverseAnim, BoneName);
-						MetaDataJson->SetArrayField(BoneNameStr, AttributeJsonArray);
 					}
 				}
 			}
@@ -367,14 +808,7 @@ static void BindDataArray(TArray<TPair<FString, EAttribute>> &DataArray,
 					DataArray.Add(NewData);
 				}
 			}
-			else if (Attribute == EAttribute::RGB_3840_2160 ||
-				Attribute == EAttribute::RGB_1280_1024 ||
-				Attribute == EAttribute::RGB_640_480 ||
-				Attribute == EAttribute::RGB_128_128 ||
-				Attribute == EAttribute::Depth_3840_2160 ||
-				Attribute == EAttribute::Depth_1280_1024 ||
-				Attribute == EAttribute::Depth_640_480 ||
-				Attribute == EAttribute::Depth_128_128)
+			else if (IsSensorAttribute(Attribute))
 			{
 				const TPair<FString, EAttribute> NewData(ObjectName, Attribute);
 				if (!DataArray.Contains(NewData))
@@ -388,32 +822,48 @@ static void BindDataArray(TArray<TPair<FString, EAttribute>> &DataArray,
 		{
 			if (UMultiverseAnim *MultiverseAnim = Cast<UMultiverseAnim>(SkeletalMeshComponent->GetAnimInstance()))
 			{
-				TArray<FName> BoneNames;
-				SkeletalMeshComponent->GetBoneNames(BoneNames);
-				BoneNames.Sort([](const FName &BoneNameA, const FName &BoneNameB)
-							   { return BoneNameB.ToString().Compare(BoneNameA.ToString()) > 0; });
-				for (const FName &BoneName : BoneNames)
+				const FMultiverseSkeletonJoints *SkeletonJoints = MultiverseAnim->GetSkeletonJoints();
+				for (int32 JointIndex = 0; SkeletonJoints != nullptr && JointIndex < SkeletonJoints->Joints.Num(); JointIndex++)
 				{
-					FString BoneNameStr = BoneName.ToString();
-					if (((BoneNameStr.EndsWith(TEXT("_revolute_bone")) && BoneNameStr.RemoveFromEnd(TEXT("_revolute_bone"))) ||
-						 (BoneNameStr.EndsWith(TEXT("_continuous_bone")) && BoneNameStr.RemoveFromEnd(TEXT("_continuous_bone")))) &&
+					const FMultiverseSkeletonJoint &Joint = SkeletonJoints->Joints[JointIndex];
+					if (SkeletalMeshComponent->GetBoneIndex(Joint.BoneName) == INDEX_NONE)
+					{
+						continue;
+					}
+
+					if ((Joint.Type == EMultiverseJointType::Revolute || Joint.Type == EMultiverseJointType::Continuous) &&
 						Object.Value.Attributes.Contains(EAttribute::JointAngularPosition))
 					{
-						const TPair<FString, EAttribute> NewData(Object.Value.ObjectPrefix + BoneNameStr + Object.Value.ObjectSuffix, EAttribute::JointAngularPosition);
+						const TPair<FString, EAttribute> NewData(Object.Value.ObjectPrefix + Joint.JointName + Object.Value.ObjectSuffix, EAttribute::JointAngularPosition);
 						if (!DataArray.Contains(NewData))
 						{
 							DataArray.Add(NewData);
 						}
 					}
-					else if ((BoneNameStr.EndsWith(TEXT("_prismatic_bone")) && BoneNameStr.RemoveFromEnd(TEXT("_prismatic_bone"))) &&
+					else if (Joint.Type == EMultiverseJointType::Prismatic &&
 							 Object.Value.Attributes.Contains(EAttribute::JointLinearPosition))
 					{
-						const TPair<FString, EAttribute> NewData(Object.Value.ObjectPrefix + BoneNameStr + Object.Value.ObjectSuffix, EAttribute::JointLinearPosition);
+						const TPair<FString, EAttribute> NewData(Object.Value.ObjectPrefix + Joint.JointName + Object.Value.ObjectSuffix, EAttribute::JointLinearPosition);
 						if (!DataArray.Contains(NewData))
 						{
 							DataArray.Add(NewData);
 						}
 					}
+					else if (Joint.Type == EMultiverseJointType::Ball || Joint.Type == EMultiverseJointType::Free)
+					{
+						const FString JointName = Object.Value.ObjectPrefix + Joint.JointName + Object.Value.ObjectSuffix;
+						for (const EAttribute Attribute : {EAttribute::JointPosition, EAttribute::JointQuaternion})
+						{
+							if ((Attribute == EAttribute::JointQuaternion || Joint.Type == EMultiverseJointType::Free) && Object.Value.Attributes.Contains(Attribute))
+							{
+								const TPair<FString, EAttribute> NewData(JointName, Attribute);
+								if (!DataArray.Contains(NewData))
+								{
+									DataArray.Add(NewData);
+								}
+							}
+						}
+					}
 				}
 			}
 			else
@@ -569,16 +1019,6 @@ static void BindDataArray(TArray<TPair<FString, EAttribute>> &DataArray,
 
 FMultiverseClient::FMultiverseClient()
 {
-	AttributeUint8DataMap[EAttribute::RGB_3840_2160].Init(0, 3840 * 2160 * 3);
-	AttributeUint8DataMap[EAttribute::RGB_1280_1024].Init(0, 1280 * 1024 * 3);
-	AttributeUint8DataMap[EAttribute::RGB_640_480].Init(0, 640 * 480 * 3);
-	AttributeUint8DataMap[EAttribute::RGB_128_128].Init(0, 128 * 128 * 3);
-
-	AttributeUint16DataMap[EAttribute::Depth_3840_2160].Init(0, 3840 * 2160);
-	AttributeUint16DataMap[EAttribute::Depth_1280_1024].Init(0, 1280 * 1024);
-	AttributeUint16DataMap[EAttribute::Depth_640_480].Init(0, 640 * 480);
-	AttributeUint16DataMap[EAttribute::Depth_128_128].Init(0, 128 * 128);
-
 	ColorMap = {
 		{FLinearColor(0, 0, 1, 1), TEXT("Blue")},
 		{FLinearColor(0, 1, 1, 1), TEXT("Cyan")},
@@ -589,86 +1029,40 @@ FMultiverseClient::FMultiverseClient()
 		{FLinearColor(1, 1, 0, 1), TEXT("Yellow")},
 		{FLinearColor(0.8, 0.1, 0, 1), TEXT("Orange")},
 		{FLinearColor(0.1, 0.1, 0.1, 1), TEXT("Gray")}};
+}
 
-	ConstructorHelpers::FObjectFinder<UTextureRenderTarget2D> RenderTargetAsset_RGBA8_3840_2160(TEXT("/Script/Engine.TextureRenderTarget2D'/MultiverseConnector/Rendering/RT_RGBA8_3840_2160.RT_RGBA8_3840_2160'"));
-	if (RenderTargetAsset_RGBA8_3840_2160.Succeeded())
-	{
-		RenderTarget_RGBA8_3840_2160 = RenderTargetAsset_RGBA8_3840_2160.Object;
-	}
-	else
-	{
-		UE_LOG(LogMultiverseClient, Error, TEXT("Failed to find RT_RGBA8_3840_2160"))
-	}
-
-	ConstructorHelpers::FObjectFinder<UTextureRenderTarget2D> RenderTargetAsset_RGBA8_1280_1024(TEXT("/Script/Engine.TextureRenderTarget2D'/MultiverseConnector/Rendering/RT_RGBA8_1280_1024.RT_RGBA8_1280_1024'"));
-	if (RenderTargetAsset_RGBA8_1280_1024.Succeeded())
-	{
-		RenderTarget_RGBA8_1280_1024 = RenderTargetAsset_RGBA8_1280_1024.Object;
-	}
-	else
-	{
-		UE_LOG(LogMultiverseClient, Error, TEXT("Failed to find RT_RGBA8_1280_1024"))
-	}
-
-	ConstructorHelpers::FObjectFinder<UTextureRenderTarget2D> RenderTargetAsset_RGBA8_640_480(TEXT("/Script/Engine.TextureRenderTarget2D'/MultiverseConnector/Rendering/RT_RGBA8_640_480.RT_RGBA8_640_480'"));
-	if (RenderTargetAsset_RGBA8_640_480.Succeeded())
-	{
-		RenderTarget_RGBA8_640_480 = RenderTargetAsset_RGBA8_640_480.Object;
-	}
-	else
-	{
-		UE_LOG(LogMultiverseClient, Error, TEXT("Failed to find RT_RGBA8_640_480"))
-	}
-
-	ConstructorHelpers::FObjectFinder<UTextureRenderTarget2D> RenderTargetAsset_RGBA8_128_128(TEXT("/Script/Engine.TextureRenderTarget2D'/MultiverseConnector/Rendering/RT_RGBA8_128_128.RT_RGBA8_128_128'"));
-	if (RenderTargetAsset_RGBA8_128_128.Succeeded())
-	{
-		RenderTarget_RGBA8_128_128 = RenderTargetAsset_RGBA8_128_128.Object;
-	}
-	else
-	{
-		UE_LOG(LogMultiverseClient, Error, TEXT("Failed to find RT_RGBA8_128_128"))
-	}
-
-	ConstructorHelpers::FObjectFinder<UTextureRenderTarget2D> RenderTargetAsset_R16_3840_2160(TEXT("/Script/Engine.TextureRenderTarget2D'/MultiverseConnector/Rendering/RT_RGBA8_3840_2160.RT_RGBA8_3840_2160'"));
-	if (RenderTargetAsset_R16_3840_2160.Succeeded())
-	{
-		RenderTarget_RGBA8_3840_2160 = RenderTargetAsset_R16_3840_2160.Object;
-	}
-	else
-	{
-		UE_LOG(LogMultiverseClient, Error, TEXT("Failed to find RT_RGBA8_3840_2160"))
-	}
-
-	ConstructorHelpers::FObjectFinder<UTextureRenderTarget2D> RenderTargetAsset_R16_1280_1024(TEXT("/Script/Engine.TextureRenderTarget2D'/MultiverseConnector/Rendering/RT_R16_1280_1024.RT_R16_1280_1024'"));
-	if (RenderTargetAsset_R16_1280_1024.Succeeded())
-	{
-		RenderTarget_R16_1280_1024 = RenderTargetAsset_R16_1280_1024.Object;
-	}
-	else
-	{
-		UE_LOG(LogMultiverseClient, Error, TEXT("Failed to find RT_R16_1280_1024"))
-	}
-
-	ConstructorHelpers::FObjectFinder<UTextureRenderTarget2D> RenderTargetAsset_R16_640_480(TEXT("/Script/Engine.TextureRenderTarget2D'/MultiverseConnector/Rendering/RT_R16_640_480.RT_R16_640_480'"));
-	if (RenderTargetAsset_R16_640_480.Succeeded())
-	{
-		RenderTarget_R16_640_480 = RenderTargetAsset_R16_640_480.Object;
-	}
-	else
-	{
-		UE_LOG(LogMultiverseClient, Error, TEXT("Failed to find RT_R16_640_480"))
+void FMultiverseClient::SplitSensorObjects(const TMap<AActor *, FAttributeContainer> &Objects,
+										   TMap<AActor *, FAttributeContainer> &OutObjects,
+										   TMap<AActor *, FAttributeContainer> &OutSensorObjects)
+{
+	OutObjects.Reset();
+	OutSensorObjects.Reset();
+	for (const TPair<AActor *, FAttributeContainer> &Object : Objects)
+	{
+		FAttributeContainer AttributeContainer = Object.Value;
+		FAttributeContainer SensorAttributeContainer = Object.Value;
+		AttributeContainer.Attributes.RemoveAll([](const EAttribute Attribute)
+												{ return IsSensorAttribute(Attribute); });
+		SensorAttributeContainer.Attributes.RemoveAll([](const EAttribute Attribute)
+													  { return !IsSensorAttribute(Attribute); });
+
+		// Objects without attributes still bind their bones, only drop them if all their attributes moved
+		if (AttributeContainer.Attributes.Num() > 0 || Object.Value.Attributes.Num() == 0)
+		{
+			OutObjects.Add(Object.Key, AttributeContainer);
+		}
+		if (SensorAttributeContainer.Attributes.Num() > 0)
+		{
+			OutSensorObjects.Add(Object.Key, SensorAttributeContainer);
+		}
 	}
+}
 
-	ConstructorHelpers::FObjectFinder<UTextureRenderTarget2D> RenderTargetAsset_R16_128_128(TEXT("/Script/Engine.TextureRenderTarget2D'/MultiverseConnector/Rendering/RT_R16_128_128.RT_R16_128_128'"));
-	if (RenderTargetAsset_R16_128_128.Succeeded())
-	{
-		RenderTarget_R16_128_128 = RenderTargetAsset_R16_128_128.Object;
-	}
-	else
-	{
-		UE_LOG(LogMultiverseClient, Error, TEXT("Failed to find RT_R16_128_128"))
-	}
+FMultiverseClient::~FMultiverseClient()
+{
+	StopCommunicationThread();
+	UnregisterPhysicsStepCallback();
+	CancelApiCalls();
 }
 
 void FMultiverseClient::Init(const FString &ServerHost, const FString &ServerPort, const FString &ClientPort,
@@ -677,10 +1071,17 @@ void FMultiverseClient::Init(const FString &ServerHost, const FString &ServerPor
 							 TMap<AActor *, FAttributeContainer> &InReceiveObjects,
 							 TMap<FString, FAttributeDataContainer> *InSendCustomObjectsPtr,
 							 TMap<FString, FAttributeDataContainer> *InReceiveCustomObjectsPtr,
-							 UWorld *InWorld)
+							 UWorld *InWorld,
+							 const FMultiverseClientSettings &InSettings)
 {
+	Settings = InSettings;
+	ReceiveJitterBuffer.Reset(Settings.JitterBufferSize);
 	SendObjects = InSendObjects;
 	ReceiveObjects = InReceiveObjects;
+	SendLayoutJson.Reset();
+	ReceiveLayoutJson.Reset();
+	bObjectsChanged = false;
+	AcknowledgedLayoutHash = 0;
 	SendCustomObjectsPtr = InSendCustomObjectsPtr;
 	ReceiveCustomObjectsPtr = InReceiveCustomObjectsPtr;
 	World = InWorld;
@@ -693,1020 +1094,2068 @@ void FMultiverseClient::Init(const FString &ServerHost, const FString &ServerPor
 
 	connect();
 
-	if (StartTime < 0.f)
+	if (StartTime < 0.0)
 	{
 		StartTime = FPlatformTime::Seconds();
 	}
+	ClockEstimator.Reset();
 }
 
-TMap<FString, FApiCallbacks> FMultiverseClient::CallApis(const TMap<FString, FApiCallbacks> &SimulationApiCallbacks)
+bool FMultiverseClient::Communicate()
 {
-	RequestMetaDataJson = MakeShareable(new FJsonObject);
-	const TSharedPtr<FJsonObject> SimulationApiCallbacksJson = MakeShareable(new FJsonObject);
-	for (const TPair<FString, FApiCallbacks> &SimulationApiCallback : SimulationApiCallbacks)
+	// Changed objects and dispatched API calls go out with a new handshake, the exchanges go on around it
+	const bool bExchangeThreadRunning = CommunicationThread.IsValid() || bPhysicsStepRunning;
+	if ((bObjectsChanged || ApiCallbacksRequestJson.IsValid()) && bSendAndReceiveDataBound && !bRehandshakeRequested && !IsMetaDataTaskRunning())
 	{
-		TArray<TSharedPtr<FJsonValue>> SimulationApiCallbacksJsonValues;
-		for (const FApiCallback &ApiCallback : SimulationApiCallback.Value.ApiCallbacks)
+		// The buffers are sized by the handshake, API calls already answered must not be sent again
+		RequestMetaDataJson = MakeShareable(new FJsonObject);
+		if (!bExchangeThreadRunning)
 		{
-			TArray<TSharedPtr<FJsonValue>> ApiCallbackArgumentsJsonValues;
-			for (const FString &Argument : ApiCallback.Arguments)
-			{
-				ApiCallbackArgumentsJsonValues.Add(MakeShareable(new FJsonValueString(Argument)));
-			}
-			TSharedPtr<FJsonObject> SimulationApiCallbackJson = MakeShareable(new FJsonObject);
-			SimulationApiCallbackJson->SetArrayField(ApiCallback.Name, ApiCallbackArgumentsJsonValues);
-			SimulationApiCallbacksJsonValues.Add(MakeShareable(new FJsonValueObject(SimulationApiCallbackJson)));
+			return communicate(true);
 		}
-		SimulationApiCallbacksJson->SetArrayField(SimulationApiCallback.Key, SimulationApiCallbacksJsonValues);
+
+		// The exchange thread runs the handshake, its bindings are deferred back to the game thread
+		bRehandshakeRequested = true;
 	}
-	RequestMetaDataJson->SetObjectField(TEXT("api_callbacks"), SimulationApiCallbacksJson);
 
-	if (ResponseMetaDataJson.IsValid())
+	if (Settings.bLockstep)
 	{
-		ResponseMetaDataJson->RemoveField(TEXT("api_callbacks_response"));
+		// The world only ticks once the server stepped, a server that stalls longer than LockstepTimeout skips the world tick of this frame
+		bool bCommunicated = communicate();
+		const double WaitStartTime = FPlatformTime::Seconds();
+		while (bCommunicated && bSendAndReceiveDataBound && LockstepServerTime >= 0.0 &&
+			   FMath::IsNearlyEqual(*world_time, LockstepServerTime, LockstepTimeTolerance) &&
+			   FPlatformTime::Seconds() - WaitStartTime < Settings.LockstepTimeout)
+		{
+			FPlatformProcess::Sleep(LockstepPollInterval);
+			bCommunicated = communicate();
+		}
+		if (bSendAndReceiveDataBound)
+		{
+			AdvanceLockstep(*world_time);
+		}
+		return bCommunicated;
 	}
 
-	bComputingRequestAndResponseMetaData = true;
-	communicate(true);
-	while (bComputingRequestAndResponseMetaData)
+	// With the physics step the round-trip runs on the physics thread, this only hands over the rest of the data
+	if (!bExchangeThreadRunning && ((!Settings.bAsyncCommunication && PhysicsStepCallback == nullptr) || !bSendAndReceiveDataBound))
 	{
-		UE_LOG(LogMultiverseClient, Warning, TEXT("Waiting for api_callbacks_response..."))
+		return communicate();
 	}
 
-	while (!ResponseMetaDataJson.IsValid() || ResponseMetaDataJson->Values.IsEmpty() || !ResponseMetaDataJson->HasField(TEXT("api_callbacks_response")))
+	// The exchange thread is in the middle of a handshake, nothing is bound to hand over
+	if (!bSendAndReceiveDataBound)
 	{
-		UE_LOG(LogMultiverseClient, Error, TEXT("Waiting for api_callbacks_response..."))
+		return true;
 	}
 
-	TMap<FString, FApiCallbacks> ApiCallbacksResponse;
-	TSharedPtr<FJsonObject> SimulationApiCallbacksResponseJson = ResponseMetaDataJson->GetObjectField(TEXT("api_callbacks_response"));
-	for (const TPair<FString, FApiCallbacks> &SimulationApiCallback : SimulationApiCallbacks)
+	if (!CommunicationThread.IsValid() && !bPhysicsStepRunning)
 	{
-		if (!SimulationApiCallbacksResponseJson->HasField(SimulationApiCallback.Key))
-		{
-			UE_LOG(LogMultiverseClient, Warning, TEXT("api_callbacks_response does not contain simulation [%s]"), *SimulationApiCallback.Key)
-			continue;
-		}
+		StartCommunicationThread();
+	}
 
-		const TArray<TSharedPtr<FJsonValue>> ApiCallbacksResponseJsonValue = SimulationApiCallbacksResponseJson->GetArrayField(SimulationApiCallback.Key);
-		FApiCallbacks ApiCallbacks;
-		for (const TSharedPtr<FJsonValue> &ApiCallbackResponseJsonValue : ApiCallbacksResponseJsonValue)
+	FMultiverseBufferSnapshot &SendSnapshot = SendSnapshots.GetWriteBuffer();
+	SendSnapshot.BufferDouble.SetNumUninitialized(send_buffer.buffer_double.size);
+	SendSnapshot.BufferUint8.SetNumUninitialized(send_buffer.buffer_uint8_t.size);
+	SendSnapshot.BufferUint16.SetNumUninitialized(send_buffer.buffer_uint16_t.size);
+	SendSnapshot.WorldTime = ComputeWorldTime();
+	GatherSendData(SendSnapshot.BufferDouble.GetData(), SendSnapshot.BufferUint8.GetData(), SendSnapshot.BufferUint16.GetData());
+	SendSnapshots.SwapWriteBuffers();
+
+	if (CommunicationThread.IsValid())
+	{
+		CommunicationThread->Wake();
+	}
+
+	if (ReceiveSnapshots.IsDirty())
+	{
+		ReceiveSnapshots.SwapReadBuffers();
+		const FMultiverseBufferSnapshot &ReceiveSnapshot = ReceiveSnapshots.Read();
+		if (ReceiveSnapshot.BufferDouble.Num() == receive_buffer.buffer_double.size)
 		{
-			for (const TPair<FString, TSharedPtr<FJsonValue>> &ApiCallbackResponse : ApiCallbackResponseJsonValue->AsObject()->Values)
-			{
-				TArray<FString> Arguments;
-				for (const TSharedPtr<FJsonValue> &Argument : ApiCallbackResponse.Value->AsArray())
-				{
-					Arguments.Add(Argument->AsString());
-				}
-				ApiCallbacks.ApiCallbacks.Add(FApiCallback{ApiCallbackResponse.Key, Arguments});
-			}
+			ReceiveJitterBuffer.Push(ReceiveSnapshot.WorldTime, ReceiveSnapshot.BufferDouble.GetData(), ReceiveSnapshot.BufferDouble.Num());
+			ApplyReceiveData(ReceiveSnapshot.BufferDouble.GetData());
 		}
-		ApiCallbacksResponse.Add(SimulationApiCallback.Key, ApiCallbacks);
 	}
 
-	return ApiCallbacksResponse;
+	return true;
 }
 
-UMaterial *FMultiverseClient::GetMaterial(const FLinearColor &Color) const
+void FMultiverseClient::Deinit()
 {
-	const FString ColorName = TEXT("M_") + ColorMap[Color];
-	return Cast<UMaterial>(StaticLoadObject(UMaterial::StaticClass(), nullptr, *(TEXT("Material'/MultiverseConnector/Assets/Materials/") + ColorName + TEXT(".") + ColorName + TEXT("'"))));
+	StopCommunicationThread();
+	UnregisterPhysicsStepCallback();
+	StopLockstep();
+	CancelApiCalls();
+	disconnect();
 }
 
-bool FMultiverseClient::compute_request_and_response_meta_data()
+void FMultiverseClient::AddSendObject(AActor *Actor, const FAttributeContainer &Attributes)
 {
-	bComputingRequestAndResponseMetaData = true;
-	ResponseMetaDataJson = MakeShareable(new FJsonObject);
-	if (response_meta_data_str.empty())
-	{
-		bComputingRequestAndResponseMetaData = false;
-		return false;
-	}
+	AddObject(SendObjects, SendLayoutJson, Actor, Attributes);
+}
 
-	FString ResponseMetaDataString(response_meta_data_str.c_str());
-	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ResponseMetaDataString);
+void FMultiverseClient::AddReceiveObject(AActor *Actor, const FAttributeContainer &Attributes)
+{
+	AddObject(ReceiveObjects, ReceiveLayoutJson, Actor, Attributes);
+}
 
-	// UE_LOG(LogMultiverseClient, Log, TEXT("%s"), *ResponseMetaDataString)
+void FMultiverseClient::AddObject(TMap<AActor *, FAttributeContainer> &Objects, const TSharedPtr<FJsonObject> &LayoutJson, AActor *Actor, const FAttributeContainer &Attributes)
+{
+	check(IsInGameThread());
 
-	bool bParseSuccess = FJsonSerializer::Deserialize(Reader, ResponseMetaDataJson) &&
-						 ResponseMetaDataJson->HasField(TEXT("time")) &&
-						 ResponseMetaDataJson->GetNumberField(TEXT("time")) >= 0.0;
+	if (Actor == nullptr)
+	{
+		UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object"))
+		return;
+	}
 
-	bComputingRequestAndResponseMetaData = false;
+	const TPair<AActor *, FAttributeContainer> Object(Actor, Attributes);
+	Objects.Add(Object);
 
-	return bParseSuccess;
+	// Without a cached layout the next handshake binds all objects anyway
+	if (LayoutJson.IsValid())
+	{
+		BindLayoutObject(LayoutJson, Object);
+	}
+	bObjectsChanged = true;
 }
 
-void FMultiverseClient::compute_request_buffer_sizes(std::map<std::string, size_t> &send_buffer_size, std::map<std::string, size_t> &receive_buffer_size) const
+void FMultiverseClient::RemoveObject(AActor *Actor)
 {
-	TMap<FString, TMap<FString, size_t>> RequestBufferSizes = {{TEXT("send"), {{TEXT("double"), 0}, {TEXT("uint8"), 0}, {TEXT("uint16"), 0}}}, {TEXT("receive"), {{TEXT("double"), 0}, {TEXT("uint8"), 0}, {TEXT("uint16"), 0}}}};
+	check(IsInGameThread());
 
-	for (TPair<FString, TMap<FString, size_t>> &RequestBufferSize : RequestBufferSizes)
+	const bool bRemoved = SendObjects.Remove(Actor) + ReceiveObjects.Remove(Actor) > 0;
+	if (!bRemoved)
 	{
-		RequestBufferSize.Value[TEXT("double")] = 0;
-		RequestBufferSize.Value[TEXT("uint8")] = 0;
-		RequestBufferSize.Value[TEXT("uint16")] = 0;
-		if (!RequestMetaDataJson->HasField(RequestBufferSize.Key))
-		{
-			continue;
-		}
-		for (const TPair<FString, TSharedPtr<FJsonValue>> &ObjectJson : RequestMetaDataJson->GetObjectField(RequestBufferSize.Key)->Values)
+		return;
+	}
+
+	TArray<FString> LayoutKeys;
+	if (ObjectLayoutKeys.RemoveAndCopyValue(Actor, LayoutKeys))
+	{
+		for (const FString &LayoutKey : LayoutKeys)
 		{
-			if (ObjectJson.Key.Compare(TEXT("")) == 0 ||
-				RequestBufferSize.Value[TEXT("double")] == -1 ||
-				RequestBufferSize.Value[TEXT("uint8")] == -1 ||
-				RequestBufferSize.Value[TEXT("uint16")] == -1)
+			if (SendLayoutJson.IsValid())
 			{
-				RequestBufferSize.Value[TEXT("double")] = -1;
-				RequestBufferSize.Value[TEXT("uint8")] = -1;
-				RequestBufferSize.Value[TEXT("uint16")] = -1;
-				break;
+				SendLayoutJson->RemoveField(LayoutKey);
 			}
-
-			for (const TSharedPtr<FJsonValue> &ObjectAttributeJson : ObjectJson.Value->AsArray())
+			if (ReceiveLayoutJson.IsValid())
 			{
-				const FString ObjectAttribute = ObjectAttributeJson->AsString();
-				if (ObjectAttribute.Compare(TEXT("")) == 0)
-				{
-					RequestBufferSize.Value[TEXT("double")] = -1;
-					RequestBufferSize.Value[TEXT("uint8")] = -1;
-					RequestBufferSize.Value[TEXT("uint16")] = -1;
-					break;
-				}
-
-				if (AttributeStringMap.Contains(ObjectAttribute) && AttributeDoubleDataMap.Contains(AttributeStringMap[ObjectAttribute]))
-				{
-					RequestBufferSize.Value[TEXT("double")] += AttributeDoubleDataMap[AttributeStringMap[ObjectAttribute]].Num();
-				}
-				else if (AttributeStringMap.Contains(ObjectAttribute) && AttributeUint8DataMap.Contains(AttributeStringMap[ObjectAttribute]))
-				{
-					RequestBufferSize.Value[TEXT("uint8")] += AttributeUint8DataMap[AttributeStringMap[ObjectAttribute]].Num();
-				}
-				else if (AttributeStringMap.Contains(ObjectAttribute) && AttributeUint16DataMap.Contains(AttributeStringMap[ObjectAttribute]))
-				{
-					RequestBufferSize.Value[TEXT("uint16")] += AttributeUint16DataMap[AttributeStringMap[ObjectAttribute]].Num();
-				}
+				ReceiveLayoutJson->RemoveField(LayoutKey);
 			}
+			CachedActors.Remove(LayoutKey);
+			CachedComponents.Remove(LayoutKey);
+			CachedBoneNames.Remove(LayoutKey);
 		}
 	}
 
-	send_buffer_size = {{"double", RequestBufferSizes[TEXT("send")][TEXT("double")]},
-						{"uint8", RequestBufferSizes[TEXT("send")][TEXT("uint8")]},
-						{"uint16", RequestBufferSizes[TEXT("send")][TEXT("uint16")]}};
-	receive_buffer_size = {{"double", RequestBufferSizes[TEXT("receive")][TEXT("double")]},
-						   {"uint8", RequestBufferSizes[TEXT("receive")][TEXT("uint8")]},
-						   {"uint16", RequestBufferSizes[TEXT("receive")][TEXT("uint16")]}};
-}
-
-void FMultiverseClient::compute_response_buffer_sizes(std::map<std::string, size_t> &send_buffer_size, std::map<std::string, size_t> &receive_buffer_size) const
-{
-	TMap<FString, TMap<FString, size_t>> ResponseBufferSizes = {{TEXT("send"), {{TEXT("double"), 0}, {TEXT("uint8"), 0}, {TEXT("uint16"), 0}}}, {TEXT("receive"), {{TEXT("double"), 0}, {TEXT("uint8"), 0}, {TEXT("uint16"), 0}}}};
-
-	for (TPair<FString, TMap<FString, size_t>> &ResponseBufferSize : ResponseBufferSizes)
+	// The buffer layout stays until the next handshake, the entries of the actor are skipped from now on.
+	// The exchange thread only touches the snapshots and the published physics bindings, so it keeps running
+	for (TArray<FMultiverseBinding> *Bindings : {&SendBindings, &ReceiveBindings})
 	{
-		ResponseBufferSize.Value[TEXT("double")] = 0;
-		ResponseBufferSize.Value[TEXT("uint8")] = 0;
-		ResponseBufferSize.Value[TEXT("uint16")] = 0;
-		if (!ResponseMetaDataJson->HasField(ResponseBufferSize.Key))
+		for (FMultiverseBinding &Binding : *Bindings)
 		{
-			continue;
-		}
-		for (const TPair<FString, TSharedPtr<FJsonValue>> &ObjectJson : ResponseMetaDataJson->GetObjectField(ResponseBufferSize.Key)->Values)
-		{
-			for (const TPair<FString, TSharedPtr<FJsonValue>> &ObjectData : ObjectJson.Value->AsObject()->Values)
+			Binding.Joints.RemoveAll([Actor](const FMultiverseAnimJoint &Joint)
+									 { return Joint.Actor == Actor; });
+			if (Binding.Actor == Actor || (Binding.Type == EMultiverseBindingType::Bone && Binding.Joints.Num() == 0))
 			{
-				const FString ObjectAttribute = ObjectData.Key;
-				if (AttributeStringMap.Contains(ObjectAttribute) && AttributeDoubleDataMap.Contains(AttributeStringMap[ObjectAttribute]))
-				{
-					ResponseBufferSize.Value[TEXT("double")] += ObjectData.Value->AsArray().Num();
-				}
-				else if (AttributeStringMap.Contains(ObjectAttribute) && AttributeUint8DataMap.Contains(AttributeStringMap[ObjectAttribute]))
-				{
-					ResponseBufferSize.Value[TEXT("uint8")] += ObjectData.Value->AsArray().Num();
-				}
-				else if (AttributeStringMap.Contains(ObjectAttribute) && AttributeUint16DataMap.Contains(AttributeStringMap[ObjectAttribute]))
-				{
-					ResponseBufferSize.Value[TEXT("uint16")] += ObjectData.Value->AsArray().Num();
-				}
+				Binding = FMultiverseBinding();
 			}
 		}
 	}
-
-	send_buffer_size = {{"double", ResponseBufferSizes[TEXT("send")][TEXT("double")]},
-						{"uint8", ResponseBufferSizes[TEXT("send")][TEXT("uint8")]},
-						{"uint16", ResponseBufferSizes[TEXT("send")][TEXT("uint16")]}};
-	receive_buffer_size = {{"double", ResponseBufferSizes[TEXT("receive")][TEXT("double")]},
-						   {"uint8", ResponseBufferSizes[TEXT("receive")][TEXT("uint8")]},
-						   {"uint16", ResponseBufferSizes[TEXT("receive")][TEXT("uint16")]}};
+	ReceiveTransformBindings.RemoveAll([Actor](const FMultiverseTransformBinding &TransformBinding)
+									   { return TransformBinding.Actor == Actor; });
+	ReceiveAnimBindings.RemoveAll([Actor](const FMultiverseAnimBinding &AnimBinding)
+								  { return AnimBinding.Actor == Actor; });
+	for (TArray<FMultiversePhysicsBinding> *PhysicsBindings : {&SendPhysicsBindings, &ReceivePhysicsBindings})
+	{
+		PhysicsBindings->RemoveAll([Actor](const FMultiversePhysicsBinding &PhysicsBinding)
+								   { return PhysicsBinding.Actor == Actor; });
+	}
+	PublishPhysicsBindings();
+	bObjectsChanged = true;
 }
 
-bool FMultiverseClient::init_objects(bool from_request_meta_data)
+void FMultiverseClient::BindLayoutObject(const TSharedPtr<FJsonObject> &LayoutJson, const TPair<AActor *, FAttributeContainer> &Object)
 {
-	SendObjects.Remove(nullptr);
-	ReceiveObjects.Remove(nullptr);
+	TSharedPtr<FJsonObject> ObjectJson = MakeShareable(new FJsonObject);
+	BindMetaData(ObjectJson, Object, CachedActors, CachedComponents, CachedBoneNames, BoundSceneCaptureComponents);
 
-	if (SendObjects.Num() > 0)
+	TArray<FString> &LayoutKeys = ObjectLayoutKeys.FindOrAdd(Object.Key);
+	for (const TPair<FString, TSharedPtr<FJsonValue>> &ObjectField : ObjectJson->Values)
 	{
-		SendObjects.ValueSort([](const FAttributeContainer &AttributeContainerA, const FAttributeContainer &AttributeContainerB)
-							  { return AttributeContainerB.ObjectName.Compare(AttributeContainerA.ObjectName) > 0; });
+		LayoutKeys.AddUnique(ObjectField.Key);
+		LayoutJson->SetField(ObjectField.Key, ObjectField.Value);
 	}
-	if (ReceiveObjects.Num() > 0)
+}
+
+void FMultiverseClient::StartCommunicationThread()
+{
+	if (PhysicsStepCallback != nullptr)
 	{
-		ReceiveObjects.ValueSort([](const FAttributeContainer &AttributeContainerA, const FAttributeContainer &AttributeContainerB)
-								 { return AttributeContainerB.ObjectName.Compare(AttributeContainerA.ObjectName) > 0; });
+		bPhysicsStepRunning = true;
+		return;
 	}
 
-	for (TPair<AActor *, FAttributeContainer> &SendObject : SendObjects)
+	const FString ThreadName = FString::Printf(TEXT("MultiverseClient_%s"), UTF8_TO_TCHAR(client_port.c_str()));
+	CommunicationThread = MakeUnique<FMultiverseCommunicationThread>([this]()
+																	 { CommunicateOnExchangeThread(); },
+																	 ThreadName, GameThreadCalls);
+}
+
+void FMultiverseClient::StopCommunicationThread()
+{
+	if (CommunicationThread.IsValid())
 	{
-		SendObject.Value.Attributes.Sort([](const EAttribute &AttributeA, const EAttribute &AttributeB)
-										 { return AttributeB > AttributeA; });
+		CommunicationThread->Shutdown();
+		CommunicationThread.Reset();
 	}
-	for (TPair<AActor *, FAttributeContainer> &ReceiveObject : ReceiveObjects)
+
+	// Like the communication thread, the step in flight may be waiting for the game thread
+	bPhysicsStepRunning = false;
+	GameThreadCalls.WaitUntil([this]()
+							  { return !bPhysicsStepInFlight; });
+
+	// Objects that changed are still flagged, the handshake is requested again if needed
+	bRehandshakeRequested = false;
+}
+
+void FMultiverseClient::RegisterPhysicsStepCallback()
+{
+	FPhysScene *PhysicsScene = World != nullptr ? World->GetPhysicsScene() : nullptr;
+	Chaos::FPhysicsSolver *Solver = PhysicsScene != nullptr ? PhysicsScene->GetSolver() : nullptr;
+	if (Solver == nullptr)
 	{
-		ReceiveObject.Value.Attributes.Sort([](const EAttribute &AttributeA, const EAttribute &AttributeB)
-											{ return AttributeB > AttributeA; });
+		UE_LOG(LogMultiverseClient, Error, TEXT("Physics scene not found, cannot communicate in the physics step"))
+		return;
 	}
-
-	if (World == nullptr)
+	if (!Solver->IsUsingAsyncResults())
 	{
-		UE_LOG(LogMultiverseClient, Error, TEXT("World is nullptr"))
-		return false;
+		UE_LOG(LogMultiverseClient, Warning, TEXT("Async physics is disabled, the physics step runs at the frame rate"))
 	}
 
-	return SendObjects.Num() > 0 || ReceiveObjects.Num() > 0 || SendCustomObjectsPtr && SendCustomObjectsPtr->Num() > 0 || ReceiveCustomObjectsPtr && ReceiveCustomObjectsPtr->Num();
-}
+	// The solver constructs the callback, the client is published to the physics thread afterwards
+	PhysicsStepCallback = Solver->CreateAndRegisterSimCallbackObject_External<FMultiversePhysicsStepCallback>();
+	PhysicsStepCallback->Client = this;
 
-void FMultiverseClient::start_connect_to_server_thread()
-{
-	ConnectToServerTask = FFunctionGraphTask::CreateAndDispatchWhenReady([&]()
-																		 { FMultiverseClient::connect_to_server(); },
-																		 TStatId(), nullptr, ENamedThreads::AnyThread);
+	// Bodies that are recreated get new proxies, e.g. after RecreatePhysicsState or when the actor is destroyed
+	CreatePhysicsStateHandle = UActorComponent::GlobalCreatePhysicsDelegate.AddRaw(this, &FMultiverseClient::OnPhysicsStateCreated);
+	DestroyPhysicsStateHandle = UActorComponent::GlobalDestroyPhysicsDelegate.AddRaw(this, &FMultiverseClient::OnPhysicsStateDestroyed);
 }
 
-void FMultiverseClient::wait_for_connect_to_server_thread_finish()
+void FMultiverseClient::UnregisterPhysicsStepCallback()
 {
-	if (ConnectToServerTask.IsValid())
+	if (PhysicsStepCallback == nullptr)
 	{
-		ConnectToServerTask->Wait();
+		return;
+	}
+
+	UActorComponent::GlobalCreatePhysicsDelegate.Remove(CreatePhysicsStateHandle);
+	UActorComponent::GlobalDestroyPhysicsDelegate.Remove(DestroyPhysicsStateHandle);
+
+	PhysicsStepCallback->Client = nullptr;
+	FPhysScene *PhysicsScene = World != nullptr ? World->GetPhysicsScene() : nullptr;
+	if (Chaos::FPhysicsSolver *Solver = PhysicsScene != nullptr ? PhysicsScene->GetSolver() : nullptr)
+	{
+		Solver->UnregisterAndFreeSimCallbackObject_External(PhysicsStepCallback);
 	}
+	PhysicsStepCallback = nullptr;
 }
 
-void FMultiverseClient::start_meta_data_thread()
+void FMultiverseClient::PublishPhysicsBindings(const UActorComponent *DestroyedComponent)
 {
-	MetaDataTask = FFunctionGraphTask::CreateAndDispatchWhenReady([&]()
-																  { FMultiverseClient::send_and_receive_meta_data(); },
-																  TStatId(), nullptr, ENamedThreads::AnyThread);
+	TSharedPtr<FMultiversePublishedPhysicsBindings, ESPMode::ThreadSafe> Bindings = MakeShared<FMultiversePublishedPhysicsBindings, ESPMode::ThreadSafe>();
+	auto Resolve = [DestroyedComponent](const TArray<FMultiversePhysicsBinding> &PhysicsBindings, TArray<FMultiversePhysicsBinding> &OutPhysicsBindings)
+	{
+		OutPhysicsBindings.Reserve(PhysicsBindings.Num());
+		for (const FMultiversePhysicsBinding &PhysicsBinding : PhysicsBindings)
+		{
+			const UPrimitiveComponent *Component = PhysicsBinding.Component.Get();
+			const FBodyInstance *BodyInstance = Component != nullptr && Component != DestroyedComponent ? Component->GetBodyInstance() : nullptr;
+			if (BodyInstance != nullptr && BodyInstance->GetPhysicsActorHandle() != nullptr)
+			{
+				FMultiversePhysicsBinding &PublishedBinding = OutPhysicsBindings.Add_GetRef(PhysicsBinding);
+				PublishedBinding.Proxy = BodyInstance->GetPhysicsActorHandle();
+			}
+		}
+	};
+	Resolve(SendPhysicsBindings, Bindings->SendBindings);
+	Resolve(ReceivePhysicsBindings, Bindings->ReceiveBindings);
+
+	FScopeLock Lock(&PublishedPhysicsBindingsCriticalSection);
+	PublishedPhysicsBindings = Bindings;
 }
 
-void FMultiverseClient::wait_for_meta_data_thread_finish()
+void FMultiverseClient::OnPhysicsStateCreated(UActorComponent *Component)
 {
-	if (MetaDataTask.IsValid())
+	auto IsBound = [Component](const FMultiversePhysicsBinding &PhysicsBinding)
+	{ return PhysicsBinding.Component == Component; };
+	if (SendPhysicsBindings.ContainsByPredicate(IsBound) || ReceivePhysicsBindings.ContainsByPredicate(IsBound))
 	{
-		MetaDataTask->Wait();
+		PublishPhysicsBindings();
 	}
 }
 
-void FMultiverseClient::bind_request_meta_data()
+void FMultiverseClient::OnPhysicsStateDestroyed(UActorComponent *Component)
 {
-	TSharedPtr<FJsonObject> ApiCallbacks;
-	TArray<TSharedPtr<FJsonValue>> ApiCallbacksResponse;
-	if (RequestMetaDataJson && RequestMetaDataJson->HasField(TEXT("api_callbacks")))
+	// Called before the body is terminated, its proxy must be gone from the physics thread before the solver frees it
+	auto IsBound = [Component](const FMultiversePhysicsBinding &PhysicsBinding)
+	{ return PhysicsBinding.Component == Component; };
+	if (SendPhysicsBindings.ContainsByPredicate(IsBound) || ReceivePhysicsBindings.ContainsByPredicate(IsBound))
 	{
-		ApiCallbacks = RequestMetaDataJson->GetObjectField(TEXT("api_callbacks"));
+		PublishPhysicsBindings(Component);
 	}
-	if (RequestMetaDataJson && RequestMetaDataJson->HasField(TEXT("api_callbacks_response")))
+}
+
+void FMultiverseClient::CommunicatePhysicsStep()
+{
+	bPhysicsStepInFlight = true;
+	if (bPhysicsStepRunning && bSendAndReceiveDataBound)
 	{
-		ApiCallbacksResponse = RequestMetaDataJson->GetArrayField(TEXT("api_callbacks_response"));
+		{
+			FScopeLock Lock(&PublishedPhysicsBindingsCriticalSection);
+			PhysicsStepBindings = PublishedPhysicsBindings;
+		}
+		PhysicsStepThreadId = FPlatformTLS::GetCurrentThreadId();
+		CommunicateOnExchangeThread();
+		PhysicsStepThreadId = 0;
+		PhysicsStepBindings.Reset();
 	}
+	bPhysicsStepInFlight = false;
+	GameThreadCalls.Notify();
+}
 
-	RequestMetaDataJson = MakeShareable(new FJsonObject);
-
-	if (ApiCallbacks)
+void FMultiverseClient::CommunicateOnExchangeThread()
+{
+	const bool bRehandshake = bRehandshakeRequested;
+	communicate(bRehandshake);
+	if (bRehandshake)
 	{
-		RequestMetaDataJson->SetObjectField(TEXT("api_callbacks"), ApiCallbacks);
+		bRehandshakeRequested = false;
 	}
-	if (ApiCallbacksResponse.Num() > 0)
+}
+
+void FMultiverseClient::GatherPhysicsSendData(double *SendBufferDoubleAddr) const
+{
+	if (!PhysicsStepBindings.IsValid())
 	{
-		RequestMetaDataJson->SetArrayField(TEXT("api_callbacks_response"), ApiCallbacksResponse);
+		return;
 	}
 
-	TSharedPtr<FJsonObject> MetaDataJson = MakeShareable(new FJsonObject);
-	MetaDataJson->SetStringField(TEXT("world_name"), WorldName);
-	MetaDataJson->SetStringField(TEXT("simulation_name"), SimulationName);
-	MetaDataJson->SetStringField(TEXT("time_unit"), TEXT("s"));
-	MetaDataJson->SetStringField(TEXT("length_unit"), TEXT("cm"));
-	MetaDataJson->SetStringField(TEXT("angle_unit"), TEXT("deg"));
-	MetaDataJson->SetStringField(TEXT("handedness"), TEXT("lhs"));
-	MetaDataJson->SetStringField(TEXT("force_unit"), TEXT("N"));
-
-	RequestMetaDataJson->SetObjectField(TEXT("meta_data"), MetaDataJson);
-
-	RequestMetaDataJson->SetObjectField(TEXT("send"), MakeShareable(new FJsonObject));
-	RequestMetaDataJson->SetObjectField(TEXT("receive"), MakeShareable(new FJsonObject));
-
-	for (const TPair<AActor *, FAttributeContainer> &SendObject : SendObjects)
+	for (const FMultiversePhysicsBinding &PhysicsBinding : PhysicsStepBindings->SendBindings)
 	{
-		if (SendObject.Key == nullptr)
+		const Chaos::FRigidBodyHandle_Internal *Handle = PhysicsBinding.Proxy->GetPhysicsThreadAPI();
+		if (Handle == nullptr)
 		{
-			UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object in SendObjects"))
 			continue;
 		}
 
-		BindMetaData(RequestMetaDataJson->GetObjectField(TEXT("send")), SendObject, CachedActors, CachedComponents, CachedBoneNames);
-	}
-
-	for (const TPair<AActor *, FAttributeContainer> &ReceiveObject : ReceiveObjects)
-	{
-		if (ReceiveObject.Key == nullptr)
+		double *DoubleAddr = SendBufferDoubleAddr + PhysicsBinding.DoubleOffset;
+		switch (PhysicsBinding.Attribute)
 		{
-			UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object in ReceiveObjects"))
-			continue;
-		}
-
-		BindMetaData(RequestMetaDataJson->GetObjectField(TEXT("receive")), ReceiveObject, CachedActors, CachedComponents, CachedBoneNames);
-	}
+		case EAttribute::Position:
+			WriteVector(DoubleAddr, Handle->GetX());
+			break;
 
-	for (TPair<FString, FAttributeDataContainer> &SendCustomObject : *SendCustomObjectsPtr)
-	{
-		BindMetaData(RequestMetaDataJson->GetObjectField(TEXT("send")), SendCustomObject);
-	}
+		case EAttribute::Quaternion:
+			WriteQuat(DoubleAddr, Handle->GetR());
+			break;
 
-	for (TPair<FString, FAttributeDataContainer> &ReceiveCustomObject : *ReceiveCustomObjectsPtr)
-	{
-		BindMetaData(RequestMetaDataJson->GetObjectField(TEXT("receive")), ReceiveCustomObject);
-	}
+		case EAttribute::LinearVelocity:
+			WriteVector(DoubleAddr, Handle->V());
+			break;
 
-	FString RequestMetaDataString;
-	TSharedRef<TJsonWriter<TCHAR>> Writer = TJsonWriterFactory<TCHAR>::Create(&RequestMetaDataString);
-	FJsonSerializer::Serialize(RequestMetaDataJson.ToSharedRef(), Writer, true);
+		case EAttribute::AngularVelocity:
+			WriteVector(DoubleAddr, FMath::RadiansToDegrees(FVector(Handle->W())));
+			break;
 
-	request_meta_data_str.clear();
-	for (size_t i = 0; i < (RequestMetaDataString.Len() + 127) / 128; i++) // Split string into multiple substrings with a length of 128 characters or less
-	{
-		const int32 StartIndex = i * 128;
-		const int32 SubstringLength = FMath::Min(128, RequestMetaDataString.Len() - StartIndex);
-		const FString Substring = RequestMetaDataString.Mid(StartIndex, SubstringLength);
-		request_meta_data_str += StringCast<ANSICHAR>(*Substring).Get();
+		default:
+			break;
+		}
 	}
-
-	UE_LOG(LogMultiverseClient, Log, TEXT("%s"), *RequestMetaDataString)
 }
 
-void FMultiverseClient::bind_response_meta_data()
+void FMultiverseClient::ApplyPhysicsReceiveData(const double *ReceiveBufferDoubleAddr) const
 {
-	if (!ResponseMetaDataJson->HasField(TEXT("send")))
+	if (!PhysicsStepBindings.IsValid())
 	{
 		return;
 	}
 
-	TSharedPtr<FJsonObject> ResponseSendObjects = ResponseMetaDataJson->GetObjectField(TEXT("send"));
-
-	for (const TPair<FString, EAttribute> &SendData : SendDataArray)
+	for (const FMultiversePhysicsBinding &PhysicsBinding : PhysicsStepBindings->ReceiveBindings)
 	{
-		const FString AttributeName = *AttributeStringMap.FindKey(SendData.Value);
-		if ((*SendCustomObjectsPtr).Contains(SendData.Key))
+		Chaos::FRigidBodyHandle_Internal *Handle = PhysicsBinding.Proxy->GetPhysicsThreadAPI();
+		if (Handle == nullptr || Handle->ObjectState() != Chaos::EObjectStateType::Dynamic)
 		{
-			TArray<TSharedPtr<FJsonValue>> CustomData = ResponseSendObjects->GetArrayField(AttributeName);
-			for (TPair<EAttribute, FDataContainer> &Attribute : (*SendCustomObjectsPtr)[SendData.Key].Attributes)
-			{
-				if (Attribute.Value.Data.Num() != CustomData.Num())
-				{
-					UE_LOG(LogMultiverseClient, Warning, TEXT("Data Size from Client [%d] mismatch with Data Size from Server [%d]"), Attribute.Value.Data.Num(), CustomData.Num())
-					continue;
-				}
-				for (size_t i = 0; i < Attribute.Value.Data.Num(); i++)
-				{
-					Attribute.Value.Data[i] = CustomData[i]->AsNumber();
-				}
-			}
+			continue;
 		}
-		else if (CachedActors.Contains(SendData.Key))
-		{
-			if (CachedActors[SendData.Key] == nullptr)
-			{
-				UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object in CachedActors"))
-				continue;
-			}
-
-			switch (SendData.Value)
-			{
-			case EAttribute::Position:
-			{
-				if (!ResponseSendObjects->HasField(AttributeName))
-				{
-					continue;
-				}
-
-				TArray<TSharedPtr<FJsonValue>> ObjectPosition = ResponseSendObjects->GetArrayField(AttributeName);
-				if (ObjectPosition.Num() != 3)
-				{
-					continue;
-				}
 
-				const double X = ObjectPosition[0]->AsNumber();
-				const double Y = ObjectPosition[1]->AsNumber();
-				const double Z = ObjectPosition[2]->AsNumber();
-				CachedActors[SendData.Key]->SetActorLocation(FVector(X, Y, Z));
-				break;
-			}
+		// Forces and torques only act on this substep, they are received again for the next one
+		const double *DoubleAddr = ReceiveBufferDoubleAddr + PhysicsBinding.DoubleOffset;
+		switch (PhysicsBinding.Attribute)
+		{
+		case EAttribute::LinearVelocity:
+			Handle->SetV(ReadVector(DoubleAddr));
+			break;
 
-			case EAttribute::Quaternion:
-			{
-				if (!ResponseSendObjects->HasField(AttributeName))
-				{
-					continue;
-				}
+		case EAttribute::AngularVelocity:
+			Handle->SetW(FMath::DegreesToRadians(ReadVector(DoubleAddr)));
+			break;
 
-				TArray<TSharedPtr<FJsonValue>> ObjectQuaternion = ResponseSendObjects->GetArrayField(AttributeName);
-				if (ObjectQuaternion.Num() != 4)
-				{
-					continue;
-				}
+		case EAttribute::Force:
+			Handle->AddForce(ReadVector(DoubleAddr));
+			break;
 
-				const double W = ObjectQuaternion[0]->AsNumber();
-				const double X = ObjectQuaternion[1]->AsNumber();
-				const double Y = ObjectQuaternion[2]->AsNumber();
-				const double Z = ObjectQuaternion[3]->AsNumber();
-				CachedActors[SendData.Key]->SetActorRotation(FQuat(X, Y, Z, W));
-				break;
-			}
+		case EAttribute::Torque:
+			Handle->AddTorque(ReadVector(DoubleAddr));
+			break;
 
-			case EAttribute::LinearVelocity:
-			{
-				if (!ResponseSendObjects->HasField(AttributeName))
-				{
-					continue;
-				}
+		default:
+			break;
+		}
+	}
+}
 
-				TArray<TSharedPtr<FJsonValue>> ObjectLinearVelocity = ResponseSendObjects->GetArrayField(AttributeName);
-				if (ObjectLinearVelocity.Num() != 3)
-				{
-					continue;
-				}
+bool FMultiverseClient::IsExchangeThread() const
+{
+	return (CommunicationThread.IsValid() && CommunicationThread->IsCommunicationThread()) || IsPhysicsStepThread();
+}
 
-				const double VelLinX = ObjectLinearVelocity[0]->AsNumber();
-				const double VelLinY = ObjectLinearVelocity[1]->AsNumber();
-				const double VelLinZ = ObjectLinearVelocity[2]->AsNumber();
-				Cast<UPrimitiveComponent>(CachedActors[SendData.Key]->GetRootComponent())->SetPhysicsLinearVelocity(FVector(VelLinX, VelLinY, VelLinZ));
-				break;
-			}
+bool FMultiverseClient::IsPhysicsStepThread() const
+{
+	return PhysicsStepThreadId == FPlatformTLS::GetCurrentThreadId();
+}
 
-			case EAttribute::AngularVelocity:
-			{
-				if (!ResponseSendObjects->HasField(AttributeName))
-				{
-					continue;
-				}
+bool FMultiverseClient::DeferToGameThread(TFunctionRef<void()> Function)
+{
+	// Without async physics the physics step may run on the game thread itself
+	if (IsInGameThread() || !IsExchangeThread())
+	{
+		return false;
+	}
 
-				TArray<TSharedPtr<FJsonValue>> ObjectAngularVelocity = ResponseSendObjects->GetArrayField(AttributeName);
-				if (ObjectAngularVelocity.Num() != 3)
-				{
-					continue;
-				}
+	// The server asked for a new handshake, the bindings touch actors and must not change under the game thread
+	GameThreadCalls.Call(Function);
+	return true;
+}
 
-				const double VelAngX = ObjectAngularVelocity[0]->AsNumber();
-				const double VelAngY = ObjectAngularVelocity[1]->AsNumber();
-				const double VelAngZ = ObjectAngularVelocity[2]->AsNumber();
-				Cast<UPrimitiveComponent>(CachedActors[SendData.Key]->GetRootComponent())->SetPhysicsAngularVelocityInDegrees(FVector(VelAngX, VelAngY, VelAngZ));
-				break;
-			}
+TFuture<TMap<FString, FApiCallbacks>> FMultiverseClient::CallApis(const TMap<FString, FApiCallbacks> &SimulationApiCallbacks, float Timeout)
+{
+	FMultiverseApiCall &ApiCall = PendingApiCalls.AddDefaulted_GetRef();
+	ApiCall.Id = NextApiCallId++;
+	ApiCall.SimulationApiCallbacks = SimulationApiCallbacks;
+	ApiCall.Timeout = Timeout;
+	return ApiCall.Promise.GetFuture();
+}
 
-			default:
-				break;
-			}
-		}
-		else if (CachedBoneNames.Contains(SendData.Key))
+void FMultiverseClient::ProcessApiCalls()
+{
+	// Answered calls are resolved by bind_response_meta_data, this only gives up on the others
+	const double Now = FPlatformTime::Seconds();
+	for (int32 ApiCallIndex = 0; ApiCallIndex < PendingApiCalls.Num();)
+	{
+		FMultiverseApiCall &ApiCall = PendingApiCalls[ApiCallIndex];
+		if (ApiCall.DispatchTime >= 0.0 && Now - ApiCall.DispatchTime >= ApiCall.Timeout)
 		{
-			switch (SendData.Value)
-			{
-			case EAttribute::JointAngularPosition:
-			{
-				if (!ResponseSendObjects->HasField(AttributeName))
-				{
-					continue;
-				}
-
-				TArray<TSharedPtr<FJsonValue>> JointAngularPosition = ResponseSendObjects->GetArrayField(AttributeName);
-				if (JointAngularPosition.Num() != 1)
-				{
-					continue;
-				}
-				for (TPair<UMultiverseAnim *, FName> &BoneNameMapping : CachedBoneNames[SendData.Key])
-				{
-					BoneNameMapping.Key->JointPoses[BoneNameMapping.Value].SetRotation(FQuat(FRotator(JointAngularPosition[0]->AsNumber(), 0.f, 0.f)));
-				}
-				break;
-			}
-
-			case EAttribute::JointLinearPosition:
-			{
-				if (!ResponseSendObjects->HasField(AttributeName))
-				{
-					continue;
-				}
+			UE_LOG(LogMultiverseClient, Warning, TEXT("api_callbacks_response of API call %u not received after %.2fs"), ApiCall.Id, ApiCall.Timeout)
+			ApiCall.Promise.SetValue(TMap<FString, FApiCallbacks>());
+			PendingApiCalls.RemoveAt(ApiCallIndex);
+			continue;
+		}
+		ApiCallIndex++;
+	}
 
-				TArray<TSharedPtr<FJsonValue>> JointLinearPosition = ResponseSendObjects->GetArrayField(AttributeName);
-				if (JointLinearPosition.Num() != 1)
-				{
-					continue;
-				}
-				for (TPair<UMultiverseAnim *, FName> &BoneNameMapping : CachedBoneNames[SendData.Key])
-				{
-					BoneNameMapping.Key->JointPoses[BoneNameMapping.Value].SetTranslation(FVector(0.f, JointLinearPosition[0]->AsNumber(), 0.f));;
-				}
-				break;
-			}
+	// Calls queued since the last handshake are sent together, while earlier ones may still wait for their response
+	if (!ApiCallbacksRequestJson.IsValid())
+	{
+		DispatchApiCalls();
+	}
+}
 
-			default:
-				break;
-			}
-		}
+void FMultiverseClient::CancelApiCalls()
+{
+	for (FMultiverseApiCall &ApiCall : PendingApiCalls)
+	{
+		ApiCall.Promise.SetValue(TMap<FString, FApiCallbacks>());
 	}
+	PendingApiCalls.Empty();
+	ApiCallbacksRequestJson.Reset();
+	DispatchedApiCallIds.Reset();
+	SentApiCallIds.Reset();
 }
 
-void FMultiverseClient::bind_api_callbacks()
+void FMultiverseClient::AdvanceLockstep(double ServerTime)
 {
-	if (!ResponseMetaDataJson->HasField(TEXT("api_callbacks")))
+	check(IsInGameThread());
+
+	// The server did not step within the timeout, the world must not move ahead of it
+	if (LockstepServerTime >= 0.0 && FMath::IsNearlyEqual(ServerTime, LockstepServerTime, LockstepTimeTolerance))
 	{
+		SetLockstepPaused(true);
 		return;
 	}
-	for (const TSharedPtr<FJsonValue> &ApiCallbackJsonValue : ResponseMetaDataJson->GetArrayField(TEXT("api_callbacks")))
+	SetLockstepPaused(false);
+
+	// Without a previous time, or after the server was reset to an earlier time, the step is only known from the next exchange
+	const bool bStepped = LockstepServerTime >= 0.0 && ServerTime > LockstepServerTime;
+	const double TimeStep = ServerTime - LockstepServerTime;
+	LockstepServerTime = ServerTime;
+	if (!bStepped)
 	{
-		const TSharedPtr<FJsonObject> ApiCallbackJson = ApiCallbackJsonValue->AsObject();
-		for (const TPair<FString, TSharedPtr<FJsonValue>> &ApiCallbackPair : ApiCallbackJson->Values)
-		{
-			if (ApiCallbackPair.Key.Compare(TEXT("is_unreal")) == 0)
-			{
-				// UE_LOG(LogMultiverseClient, Log, TEXT("Received!"))
-			}
-		}
+		return;
+	}
+
+	if (!bLockstepFixedTimeStep)
+	{
+		bPreviousUseFixedTimeStep = FApp::UseFixedTimeStep();
+		PreviousFixedDeltaTime = FApp::GetFixedDeltaTime();
+		FApp::SetUseFixedTimeStep(true);
+		bLockstepFixedTimeStep = true;
 	}
+	FApp::SetFixedDeltaTime(TimeStep);
 }
 
-void FMultiverseClient::bind_api_callbacks_response()
+void FMultiverseClient::StopLockstep()
 {
-	if (!ResponseMetaDataJson->HasField(TEXT("api_callbacks")))
+	LockstepServerTime = -1.0;
+	SetLockstepPaused(false);
+	if (bLockstepFixedTimeStep)
+	{
+		FApp::SetUseFixedTimeStep(bPreviousUseFixedTimeStep);
+		FApp::SetFixedDeltaTime(PreviousFixedDeltaTime);
+		bLockstepFixedTimeStep = false;
+	}
+}
+
+void FMultiverseClient::SetLockstepPaused(bool bPaused)
+{
+	// A game that was paused by someone else stays paused
+	if (bPaused == bLockstepPaused || World == nullptr || (bPaused && UGameplayStatics::IsGamePaused(World)))
 	{
 		return;
 	}
-	TArray<TSharedPtr<FJsonValue>> ApiCallbacksResponse;
-	for (const TSharedPtr<FJsonValue> &ApiCallbackJsonValue : ResponseMetaDataJson->GetArrayField(TEXT("api_callbacks")))
+
+	if (UGameplayStatics::SetGamePaused(World, bPaused))
 	{
-		const TSharedPtr<FJsonObject> ApiCallbackResponseJson = MakeShareable(new FJsonObject);
-		for (const TPair<FString, TSharedPtr<FJsonValue>> &ApiCallbackPair : ApiCallbackJsonValue->AsObject()->Values)
-		{
-			if (ApiCallbackPair.Key.Compare(TEXT("is_unreal")) == 0)
-			{
-				ApiCallbackResponseJson->SetArrayField(ApiCallbackPair.Key, {MakeShareable(new FJsonValueString(TEXT("true")))});
-			}
-			else
-			{
-				ApiCallbackResponseJson->SetArrayField(ApiCallbackPair.Key, {MakeShareable(new FJsonValueString(TEXT("not implemented")))});
-			}
-			ApiCallbacksResponse.Add(MakeShareable(new FJsonValueObject(ApiCallbackResponseJson)));
-		}
+		bLockstepPaused = bPaused;
 	}
-	RequestMetaDataJson->SetArrayField(TEXT("api_callbacks_response"), ApiCallbacksResponse);
 }
 
-void FMultiverseClient::init_send_and_receive_data()
+bool FMultiverseClient::IsMetaDataTaskRunning() const
 {
-	for (const TPair<AActor *, FAttributeContainer> &SendObject : SendObjects)
+	return bComputingRequestAndResponseMetaData || (MetaDataTask.IsValid() && !MetaDataTask->IsComplete());
+}
+
+void FMultiverseClient::DispatchApiCalls()
+{
+	TMap<FString, TArray<TSharedPtr<FJsonValue>>> SimulationApiCallbacksJsonValues;
+	const double DispatchTime = FPlatformTime::Seconds();
+	for (FMultiverseApiCall &ApiCall : PendingApiCalls)
 	{
-		if (SendObject.Key == nullptr)
+		if (ApiCall.DispatchTime >= 0.0)
 		{
-			UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object in SendObjects"))
 			continue;
 		}
 
-		BindDataArray(SendDataArray, SendObject);
-	}
-
-	for (const TPair<AActor *, FAttributeContainer> &ReceiveObject : ReceiveObjects)
-	{
-		if (ReceiveObject.Key == nullptr)
+		for (const TPair<FString, FApiCallbacks> &SimulationApiCallback : ApiCall.SimulationApiCallbacks)
 		{
-			UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object in ReceiveObjects"))
-			continue;
+			TArray<TSharedPtr<FJsonValue>> &ApiCallbacksJsonValues = SimulationApiCallbacksJsonValues.FindOrAdd(SimulationApiCallback.Key);
+			ApiCall.CallbackOffsets.Add(SimulationApiCallback.Key, ApiCallbacksJsonValues.Num());
+			for (const FApiCallback &ApiCallback : SimulationApiCallback.Value.ApiCallbacks)
+			{
+				TArray<TSharedPtr<FJsonValue>> ApiCallbackArgumentsJsonValues;
+				for (const FString &Argument : ApiCallback.Arguments)
+				{
+					ApiCallbackArgumentsJsonValues.Add(MakeShareable(new FJsonValueString(Argument)));
+				}
+				TSharedPtr<FJsonObject> SimulationApiCallbackJson = MakeShareable(new FJsonObject);
+				SimulationApiCallbackJson->SetArrayField(ApiCallback.Name, ApiCallbackArgumentsJsonValues);
+				ApiCallbacksJsonValues.Add(MakeShareable(new FJsonValueObject(SimulationApiCallbackJson)));
+			}
 		}
-
-		BindDataArray(ReceiveDataArray, ReceiveObject);
+		ApiCall.DispatchTime = DispatchTime;
+		DispatchedApiCallIds.Add(ApiCall.Id);
 	}
 
-	for (const TPair<FString, FAttributeDataContainer> &SendCustomObject : *SendCustomObjectsPtr)
+	if (DispatchedApiCallIds.Num() == 0)
 	{
-		BindDataArray(SendDataArray, SendCustomObject);
+		return;
 	}
 
-	for (const TPair<FString, FAttributeDataContainer> &ReceiveCustomObject : *ReceiveCustomObjectsPtr)
+	ApiCallbacksRequestJson = MakeShareable(new FJsonObject);
+	for (const TPair<FString, TArray<TSharedPtr<FJsonValue>>> &SimulationApiCallbacksJsonValue : SimulationApiCallbacksJsonValues)
 	{
-		BindDataArray(ReceiveDataArray, ReceiveCustomObject);
+		ApiCallbacksRequestJson->SetArrayField(SimulationApiCallbacksJsonValue.Key, SimulationApiCallbacksJsonValue.Value);
 	}
 }
 
-void FMultiverseClient::bind_send_data()
+void FMultiverseClient::ResolveApiCalls()
 {
-	*world_time = FPlatformTime::Seconds() - StartTime;
-	if (*world_time < 0.0)
+	check(IsInGameThread());
+
+	if (SentApiCallIds.Num() == 0)
+	{
+		return;
+	}
+
+	const TSharedPtr<FJsonObject> *SimulationApiCallbacksResponseJson = nullptr;
+	if (!ResponseMetaDataJson->TryGetObjectField(TEXT("api_callbacks_response"), SimulationApiCallbacksResponseJson))
 	{
-		*world_time = 0.0;
+		UE_LOG(LogMultiverseClient, Warning, TEXT("Response meta data does not contain api_callbacks_response for %d API calls"), SentApiCallIds.Num())
 	}
-	double *send_buffer_double_addr = send_buffer.buffer_double.data;
-	uint8_t *send_buffer_uint8_addr = send_buffer.buffer_uint8_t.data;
-	uint16_t *send_buffer_uint16_addr = send_buffer.buffer_uint16_t.data;
 
-	for (const TPair<FString, EAttribute> &SendData : SendDataArray)
+	for (const uint32 ApiCallId : SentApiCallIds)
 	{
-		if ((*SendCustomObjectsPtr).Contains(SendData.Key))
+		// Calls that timed out are already gone
+		const int32 ApiCallIndex = PendingApiCalls.IndexOfByPredicate([ApiCallId](const FMultiverseApiCall &ApiCall)
+																	  { return ApiCall.Id == ApiCallId; });
+		if (ApiCallIndex == INDEX_NONE)
 		{
-			for (const TPair<EAttribute, FDataContainer> &Attribute : (*SendCustomObjectsPtr)[SendData.Key].Attributes)
-			{
-				for (const double &Data : Attribute.Value.Data)
-				{
-					*send_buffer_double_addr++ = Data;
-				}
-			}
+			continue;
 		}
-		else if (CachedActors.Contains(SendData.Key))
+
+		FMultiverseApiCall &ApiCall = PendingApiCalls[ApiCallIndex];
+		ApiCall.Promise.SetValue(SimulationApiCallbacksResponseJson != nullptr ? GetApiCallbacksResponse(ApiCall, *SimulationApiCallbacksResponseJson) : TMap<FString, FApiCallbacks>());
+		PendingApiCalls.RemoveAt(ApiCallIndex);
+	}
+	SentApiCallIds.Reset();
+}
+
+TMap<FString, FApiCallbacks> FMultiverseClient::GetApiCallbacksResponse(const FMultiverseApiCall &ApiCall, const TSharedPtr<FJsonObject> &SimulationApiCallbacksResponseJson) const
+{
+	TMap<FString, FApiCallbacks> ApiCallbacksResponse;
+	for (const TPair<FString, FApiCallbacks> &SimulationApiCallback : ApiCall.SimulationApiCallbacks)
+	{
+		if (!SimulationApiCallbacksResponseJson->HasField(SimulationApiCallback.Key))
 		{
-			if (CachedActors[SendData.Key] == nullptr)
-			{
-				UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object in CachedActors"))
-				continue;
-			}
+			UE_LOG(LogMultiverseClient, Warning, TEXT("api_callbacks_response does not contain simulation [%s]"), *SimulationApiCallback.Key)
+			continue;
+		}
 
-			if (SendData.Key.Compare(TEXT("PlayerPawn")) == 0)
+		// The simulator answers the callbacks of all calls of the handshake in order, one response each
+		const TArray<TSharedPtr<FJsonValue>> &ApiCallbacksResponseJsonValue = SimulationApiCallbacksResponseJson->GetArrayField(SimulationApiCallback.Key);
+		const int32 CallbackOffset = ApiCall.CallbackOffsets.FindRef(SimulationApiCallback.Key);
+		const int32 CallbackEnd = FMath::Min(CallbackOffset + SimulationApiCallback.Value.ApiCallbacks.Num(), ApiCallbacksResponseJsonValue.Num());
+		FApiCallbacks ApiCallbacks;
+		for (int32 CallbackIndex = CallbackOffset; CallbackIndex < CallbackEnd; CallbackIndex++)
+		{
+			for (const TPair<FString, TSharedPtr<FJsonValue>> &ApiCallbackResponse : ApiCallbacksResponseJsonValue[CallbackIndex]->AsObject()->Values)
 			{
-				APawn *PlayerPawn = UGameplayStatics::GetPlayerPawn(World, 0);
-				const FString Tag = TEXT("Head");
-				TArray<UActorComponent *> ActorComponents = PlayerPawn->GetComponentsByTag(UCameraComponent::StaticClass(), *Tag);
-				if (ActorComponents.Num() != 1)
-				{
-					UE_LOG(LogMultiverseClient, Warning, TEXT("Found %d %s"), ActorComponents.Num(), *Tag)
-					continue;
-				}
-				UCameraComponent *CameraComponent = Cast<UCameraComponent>(ActorComponents[0]);
-				switch (SendData.Value)
-				{
-				case EAttribute::Position:
-				{
-					const FVector CameraLocation = CameraComponent->GetComponentLocation();
-					*send_buffer_double_addr++ = CameraLocation.X;
-					*send_buffer_double_addr++ = CameraLocation.Y;
-					*send_buffer_double_addr++ = CameraLocation.Z;
-					break;
-				}
-
-				case EAttribute::Quaternion:
+				TArray<FString> Arguments;
+				for (const TSharedPtr<FJsonValue> &Argument : ApiCallbackResponse.Value->AsArray())
 				{
-					const FQuat CameraQuat = CameraComponent->GetComponentQuat();
-					*send_buffer_double_addr++ = CameraQuat.W;
-					*send_buffer_double_addr++ = CameraQuat.X;
-					*send_buffer_double_addr++ = CameraQuat.Y;
-					*send_buffer_double_addr++ = CameraQuat.Z;
-					break;
-				}
+					Arguments.Add(Argument->AsString());
 				}
+				ApiCallbacks.ApiCallbacks.Add(FApiCallback{ApiCallbackResponse.Key, Arguments});
+			}
+		}
+		ApiCallbacksResponse.Add(SimulationApiCallback.Key, ApiCallbacks);
+	}
+
+	return ApiCallbacksResponse;
+}
+
+UMaterial *FMultiverseClient::GetMaterial(const FLinearColor &Color) const
+{
+	const FString ColorName = TEXT("M_") + ColorMap[Color];
+	return Cast<UMaterial>(StaticLoadObject(UMaterial::StaticClass(), nullptr, *(TEXT("Material'/MultiverseConnector/Assets/Materials/") + ColorName + TEXT(".") + ColorName + TEXT("'"))));
+}
+
+bool FMultiverseClient::compute_request_and_response_meta_data()
+{
+	bComputingRequestAndResponseMetaData = true;
+	ResponseMetaDataJson = MakeShareable(new FJsonObject);
+	ResponseSendData.Reset();
+	ResponseReceiveData.Reset();
+	if (response_meta_data_str.empty())
+	{
+		AcknowledgedLayoutHash = 0;
+		bComputingRequestAndResponseMetaData = false;
+		return false;
+	}
+
+	FString ResponseMetaDataString(response_meta_data_str.c_str());
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ResponseMetaDataString);
+
+	// UE_LOG(LogMultiverseClient, Log, TEXT("%s"), *ResponseMetaDataString)
+
+	bool bParseSuccess = ReadResponseMetaData(*Reader, ResponseMetaDataJson, ResponseSendData, ResponseReceiveData) &&
+						 ResponseMetaDataJson->HasField(TEXT("time")) &&
+						 ResponseMetaDataJson->GetNumberField(TEXT("time")) >= 0.0;
+
+	// A server that knows the layout echoes its hash at the top level, anything else gets the full layout again
+	FString ResponseLayoutHash;
+	AcknowledgedLayoutHash = bParseSuccess && ResponseMetaDataJson->TryGetStringField(TEXT("layout_hash"), ResponseLayoutHash) &&
+									 ResponseLayoutHash == FString::Printf(TEXT("%016llx"), LayoutHash)
+								 ? LayoutHash
+								 : 0;
+
+	bComputingRequestAndResponseMetaData = false;
+
+	return bParseSuccess;
+}
+
+void FMultiverseClient::compute_request_buffer_sizes(std::map<std::string, size_t> &send_buffer_size, std::map<std::string, size_t> &receive_buffer_size) const
+{
+	TMap<FString, TMap<FString, size_t>> RequestBufferSizes = {{TEXT("send"), {{TEXT("double"), 0}, {TEXT("uint8"), 0}, {TEXT("uint16"), 0}}}, {TEXT("receive"), {{TEXT("double"), 0}, {TEXT("uint8"), 0}, {TEXT("uint16"), 0}}}};
+
+	for (TPair<FString, TMap<FString, size_t>> &RequestBufferSize : RequestBufferSizes)
+	{
+		RequestBufferSize.Value[TEXT("double")] = 0;
+		RequestBufferSize.Value[TEXT("uint8")] = 0;
+		RequestBufferSize.Value[TEXT("uint16")] = 0;
+		if (!RequestMetaDataJson->HasField(RequestBufferSize.Key))
+		{
+			continue;
+		}
+		for (const TPair<FString, TSharedPtr<FJsonValue>> &ObjectJson : RequestMetaDataJson->GetObjectField(RequestBufferSize.Key)->Values)
+		{
+			if (ObjectJson.Key.Compare(TEXT("")) == 0 ||
+				RequestBufferSize.Value[TEXT("double")] == -1 ||
+				RequestBufferSize.Value[TEXT("uint8")] == -1 ||
+				RequestBufferSize.Value[TEXT("uint16")] == -1)
+			{
+				RequestBufferSize.Value[TEXT("double")] = -1;
+				RequestBufferSize.Value[TEXT("uint8")] = -1;
+				RequestBufferSize.Value[TEXT("uint16")] = -1;
+				break;
+			}
+
+			for (const TSharedPtr<FJsonValue> &ObjectAttributeJson : ObjectJson.Value->AsArray())
+			{
+				const FString ObjectAttribute = ObjectAttributeJson->AsString();
+				if (ObjectAttribute.Compare(TEXT("")) == 0)
+				{
+					RequestBufferSize.Value[TEXT("double")] = -1;
+					RequestBufferSize.Value[TEXT("uint8")] = -1;
+					RequestBufferSize.Value[TEXT("uint16")] = -1;
+					break;
+				}
+
+				FString BufferType;
+				int32 BufferSize = 0;
+				if (GetAttributeBufferSize(ObjectAttribute, BufferType, BufferSize))
+				{
+					if (BufferType != TEXT("double"))
+					{
+						BufferSize = GetImageSlotSize(BufferSize, BufferType == TEXT("uint8") ? sizeof(uint8) : sizeof(uint16), Settings);
+					}
+					RequestBufferSize.Value[BufferType] += BufferSize;
+				}
+			}
+		}
+	}
+
+	send_buffer_size = {{"double", RequestBufferSizes[TEXT("send")][TEXT("double")]},
+						{"uint8", RequestBufferSizes[TEXT("send")][TEXT("uint8")]},
+						{"uint16", RequestBufferSizes[TEXT("send")][TEXT("uint16")]}};
+	receive_buffer_size = {{"double", RequestBufferSizes[TEXT("receive")][TEXT("double")]},
+						   {"uint8", RequestBufferSizes[TEXT("receive")][TEXT("uint8")]},
+						   {"uint16", RequestBufferSizes[TEXT("receive")][TEXT("uint16")]}};
+}
+
+void FMultiverseClient::compute_response_buffer_sizes(std::map<std::string, size_t> &send_buffer_size, std::map<std::string, size_t> &receive_buffer_size) const
+{
+	send_buffer_size = {{"double", ResponseSendData.DoubleNum},
+						{"uint8", ResponseSendData.Uint8Num},
+						{"uint16", ResponseSendData.Uint16Num}};
+	receive_buffer_size = {{"double", ResponseReceiveData.DoubleNum},
+						   {"uint8", ResponseReceiveData.Uint8Num},
+						   {"uint16", ResponseReceiveData.Uint16Num}};
+}
+
+bool FMultiverseClient::init_objects(bool from_request_meta_data)
+{
+	bool bResult = false;
+	if (DeferToGameThread([this, &bResult, from_request_meta_data]()
+						  { bResult = init_objects(from_request_meta_data); }))
+	{
+		return bResult;
+	}
+
+	SendObjects.Remove(nullptr);
+	ReceiveObjects.Remove(nullptr);
+
+	if (SendObjects.Num() > 0)
+	{
+		SendObjects.ValueSort([](const FAttributeContainer &AttributeContainerA, const FAttributeContainer &AttributeContainerB)
+							  { return AttributeContainerB.ObjectName.Compare(AttributeContainerA.ObjectName) > 0; });
+	}
+	if (ReceiveObjects.Num() > 0)
+	{
+		ReceiveObjects.ValueSort([](const FAttributeContainer &AttributeContainerA, const FAttributeContainer &AttributeContainerB)
+								 { return AttributeContainerB.ObjectName.Compare(AttributeContainerA.ObjectName) > 0; });
+	}
+
+	for (TPair<AActor *, FAttributeContainer> &SendObject : SendObjects)
+	{
+		SendObject.Value.Attributes.Sort([](const EAttribute &AttributeA, const EAttribute &AttributeB)
+										 { return AttributeB > AttributeA; });
+	}
+	for (TPair<AActor *, FAttributeContainer> &ReceiveObject : ReceiveObjects)
+	{
+		ReceiveObject.Value.Attributes.Sort([](const EAttribute &AttributeA, const EAttribute &AttributeB)
+											{ return AttributeB > AttributeA; });
+	}
+
+	if (World == nullptr)
+	{
+		UE_LOG(LogMultiverseClient, Error, TEXT("World is nullptr"))
+		return false;
+	}
+
+	return SendObjects.Num() > 0 || ReceiveObjects.Num() > 0 || SendCustomObjectsPtr && SendCustomObjectsPtr->Num() > 0 || ReceiveCustomObjectsPtr && ReceiveCustomObjectsPtr->Num();
+}
+
+void FMultiverseClient::start_connect_to_server_thread()
+{
+	ConnectToServerTask = FFunctionGraphTask::CreateAndDispatchWhenReady([&]()
+																		 { FMultiverseClient::connect_to_server(); },
+																		 TStatId(), nullptr, ENamedThreads::AnyThread);
+}
+
+void FMultiverseClient::wait_for_connect_to_server_thread_finish()
+{
+	if (ConnectToServerTask.IsValid())
+	{
+		ConnectToServerTask->Wait();
+	}
+}
+
+void FMultiverseClient::start_meta_data_thread()
+{
+	MetaDataTask = FFunctionGraphTask::CreateAndDispatchWhenReady([&]()
+																  { FMultiverseClient::send_and_receive_meta_data(); },
+																  TStatId(), nullptr, ENamedThreads::AnyThread);
+}
+
+void FMultiverseClient::wait_for_meta_data_thread_finish()
+{
+	if (MetaDataTask.IsValid())
+	{
+		MetaDataTask->Wait();
+	}
+}
+
+void FMultiverseClient::bind_request_meta_data()
+{
+	if (DeferToGameThread([this]()
+						  { bind_request_meta_data(); }))
+	{
+		return;
+	}
+
+	TArray<TSharedPtr<FJsonValue>> ApiCallbacksResponse;
+	if (RequestMetaDataJson && RequestMetaDataJson->HasField(TEXT("api_callbacks_response")))
+	{
+		ApiCallbacksResponse = RequestMetaDataJson->GetArrayField(TEXT("api_callbacks_response"));
+	}
+
+	RequestMetaDataJson = MakeShareable(new FJsonObject);
+
+	// Dispatched API calls are sent once, the response meta data of this handshake answers them
+	SentApiCallIds = MoveTemp(DispatchedApiCallIds);
+	DispatchedApiCallIds.Reset();
+	if (ApiCallbacksRequestJson.IsValid())
+	{
+		RequestMetaDataJson->SetObjectField(TEXT("api_callbacks"), ApiCallbacksRequestJson);
+		ApiCallbacksRequestJson.Reset();
+	}
+	if (ApiCallbacksResponse.Num() > 0)
+	{
+		RequestMetaDataJson->SetArrayField(TEXT("api_callbacks_response"), ApiCallbacksResponse);
+	}
+
+	bObjectsChanged = false;
+
+	TSharedPtr<FJsonObject> MetaDataJson = MakeShareable(new FJsonObject);
+	MetaDataJson->SetStringField(TEXT("world_name"), WorldName);
+	MetaDataJson->SetStringField(TEXT("simulation_name"), SimulationName);
+	MetaDataJson->SetStringField(TEXT("time_unit"), TEXT("s"));
+	MetaDataJson->SetStringField(TEXT("length_unit"), TEXT("cm"));
+	MetaDataJson->SetStringField(TEXT("angle_unit"), TEXT("deg"));
+	MetaDataJson->SetStringField(TEXT("handedness"), TEXT("lhs"));
+	MetaDataJson->SetStringField(TEXT("force_unit"), TEXT("N"));
+	if (Settings.ImageEncoding != EMultiverseImageEncoding::None)
+	{
+		// Image slots then start with the uint32 byte size of the encoded image and the float64 world time it was captured at
+		MetaDataJson->SetStringField(TEXT("image_encoding"), MultiverseImageEncoder::GetEncodingName(Settings.ImageEncoding));
+		MetaDataJson->SetStringField(TEXT("depth_encoding"), MultiverseImageEncoder::GetEncodingName(MultiverseImageEncoder::GetEffectiveEncoding(Settings.ImageEncoding, sizeof(uint16))));
+	}
+
+	// The actor objects are bound once, reconnects and API calls reuse their layout until the objects change
+	if (!SendLayoutJson.IsValid() || !ReceiveLayoutJson.IsValid())
+	{
+		SendLayoutJson = MakeShareable(new FJsonObject);
+		ReceiveLayoutJson = MakeShareable(new FJsonObject);
+		ObjectLayoutKeys.Empty();
+		for (const TPair<AActor *, FAttributeContainer> &SendObject : SendObjects)
+		{
+			if (SendObject.Key == nullptr)
+			{
+				UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object in SendObjects"))
+				continue;
+			}
+
+			BindLayoutObject(SendLayoutJson, SendObject);
+		}
+
+		for (const TPair<AActor *, FAttributeContainer> &ReceiveObject : ReceiveObjects)
+		{
+			if (ReceiveObject.Key == nullptr)
+			{
+				UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object in ReceiveObjects"))
+				continue;
+			}
+
+			BindLayoutObject(ReceiveLayoutJson, ReceiveObject);
+		}
+	}
+
+	TSharedPtr<FJsonObject> SendJson = MakeShareable(new FJsonObject(*SendLayoutJson));
+	TSharedPtr<FJsonObject> ReceiveJson = MakeShareable(new FJsonObject(*ReceiveLayoutJson));
+	for (TPair<FString, FAttributeDataContainer> &SendCustomObject : *SendCustomObjectsPtr)
+	{
+		BindMetaData(SendJson, SendCustomObject);
+	}
+
+	for (TPair<FString, FAttributeDataContainer> &ReceiveCustomObject : *ReceiveCustomObjectsPtr)
+	{
+		BindMetaData(ReceiveJson, ReceiveCustomObject);
+	}
+
+	// Encoded images are smaller than the raw buffer sizes the attribute names imply
+	if (Settings.ImageEncoding != EMultiverseImageEncoding::None)
+	{
+		TSharedPtr<FJsonObject> ImageSlotSizesJson = MakeShareable(new FJsonObject);
+		for (const TSharedPtr<FJsonObject> &ObjectsJson : {SendJson, ReceiveJson})
+		{
+			for (const TPair<FString, TSharedPtr<FJsonValue>> &ObjectJson : ObjectsJson->Values)
+			{
+				for (const TSharedPtr<FJsonValue> &ObjectAttributeJson : ObjectJson.Value->AsArray())
+				{
+					const FString ObjectAttribute = ObjectAttributeJson->AsString();
+					FString BufferType;
+					int32 BufferSize = 0;
+					if (GetAttributeBufferSize(ObjectAttribute, BufferType, BufferSize) && BufferType != TEXT("double"))
+					{
+						ImageSlotSizesJson->SetNumberField(ObjectAttribute, GetImageSlotSize(BufferSize, BufferType == TEXT("uint8") ? sizeof(uint8) : sizeof(uint16), Settings));
+					}
+				}
+			}
+		}
+		MetaDataJson->SetObjectField(TEXT("image_slot_sizes"), ImageSlotSizesJson);
+	}
+
+	// The layout is serialized on its own for its hash, a server that acknowledged the hash does not get an unchanged layout again
+	FString SendString;
+	FString ReceiveString;
+	FJsonSerializer::Serialize(SendJson.ToSharedRef(), TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&SendString), true);
+	FJsonSerializer::Serialize(ReceiveJson.ToSharedRef(), TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&ReceiveString), true);
+	LayoutHash = CityHash64WithSeed(reinterpret_cast<const char *>(*ReceiveString), ReceiveString.Len() * sizeof(TCHAR),
+									CityHash64(reinterpret_cast<const char *>(*SendString), SendString.Len() * sizeof(TCHAR)));
+	MetaDataJson->SetStringField(TEXT("layout_hash"), FString::Printf(TEXT("%016llx"), LayoutHash));
+
+	RequestMetaDataJson->SetObjectField(TEXT("meta_data"), MetaDataJson);
+
+	FString RequestMetaDataString;
+	FJsonSerializer::Serialize(RequestMetaDataJson.ToSharedRef(), TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&RequestMetaDataString), true);
+	if (LayoutHash != AcknowledgedLayoutHash)
+	{
+		RequestMetaDataString.LeftChopInline(1);
+		RequestMetaDataString += TEXT(",\"send\":") + SendString + TEXT(",\"receive\":") + ReceiveString + TEXT("}");
+	}
+
+	// The buffers are sized from the full layout, whether it went out or not
+	RequestMetaDataJson->SetObjectField(TEXT("send"), SendJson);
+	RequestMetaDataJson->SetObjectField(TEXT("receive"), ReceiveJson);
+
+	const FTCHARToUTF8 RequestMetaDataUtf8(*RequestMetaDataString);
+	request_meta_data_str.assign(RequestMetaDataUtf8.Get(), RequestMetaDataUtf8.Length());
+
+	UE_LOG(LogMultiverseClient, Verbose, TEXT("%s"), *RequestMetaDataString)
+}
+
+void FMultiverseClient::bind_response_meta_data()
+{
+	if (DeferToGameThread([this]()
+						  { bind_response_meta_data(); }))
+	{
+		return;
+	}
+
+	ResolveApiCalls();
+
+	// The world starts in lockstep at the time the server reported in the handshake
+	if (Settings.bLockstep && ResponseMetaDataJson->HasTypedField<EJson::Number>(TEXT("time")))
+	{
+		LockstepServerTime = ResponseMetaDataJson->GetNumberField(TEXT("time"));
+	}
+
+	// The attributes of an object are consecutive, so each object is looked up once
+	int32 ResolvedObjectIndex = INDEX_NONE;
+	FAttributeDataContainer *CustomObject = nullptr;
+	AActor *Actor = nullptr;
+	TMap<UMultiverseAnim *, FName> *BoneNameMappings = nullptr;
+	for (const FMultiverseResponseAttribute &ResponseAttribute : ResponseSendData.Attributes)
+	{
+		if (ResponseAttribute.ObjectIndex != ResolvedObjectIndex)
+		{
+			ResolvedObjectIndex = ResponseAttribute.ObjectIndex;
+			const FString &ObjectName = ResponseSendData.ObjectNames[ResolvedObjectIndex];
+			CustomObject = SendCustomObjectsPtr->Find(ObjectName);
+			AActor *const *CachedActor = CustomObject == nullptr ? CachedActors.Find(ObjectName) : nullptr;
+			Actor = CachedActor != nullptr ? *CachedActor : nullptr;
+			BoneNameMappings = CustomObject == nullptr && CachedActor == nullptr ? CachedBoneNames.Find(ObjectName) : nullptr;
+		}
+
+		const double *Values = ResponseSendData.Values.GetData() + ResponseAttribute.ValueOffset;
+		const int32 ValueNum = ResponseAttribute.ValueNum;
+		if (CustomObject != nullptr)
+		{
+			FDataContainer *CustomData = CustomObject->Attributes.Find(ResponseAttribute.Attribute);
+			if (CustomData == nullptr)
+			{
+				continue;
+			}
+			if (CustomData->Data.Num() != ValueNum)
+			{
+				UE_LOG(LogMultiverseClient, Warning, TEXT("Data Size from Client [%d] mismatch with Data Size from Server [%d]"), CustomData->Data.Num(), ValueNum)
+				continue;
+			}
+			FMemory::Memcpy(CustomData->Data.GetData(), Values, ValueNum * sizeof(double));
+			continue;
+		}
+
+		if (ValueNum != AttributeDoubleDataMap[ResponseAttribute.Attribute].Num())
+		{
+			continue;
+		}
+
+		if (Actor != nullptr)
+		{
+			switch (ResponseAttribute.Attribute)
+			{
+			case EAttribute::Position:
+				Actor->SetActorLocation(FVector(Values[0], Values[1], Values[2]));
+				break;
+
+			case EAttribute::Quaternion:
+				Actor->SetActorRotation(FQuat(Values[1], Values[2], Values[3], Values[0]));
+				break;
+
+			case EAttribute::LinearVelocity:
+				if (UPrimitiveComponent *PrimitiveComponent = Cast<UPrimitiveComponent>(Actor->GetRootComponent()))
+				{
+					PrimitiveComponent->SetPhysicsLinearVelocity(FVector(Values[0], Values[1], Values[2]));
+				}
+				break;
+
+			case EAttribute::AngularVelocity:
+				if (UPrimitiveComponent *PrimitiveComponent = Cast<UPrimitiveComponent>(Actor->GetRootComponent()))
+				{
+					PrimitiveComponent->SetPhysicsAngularVelocityInDegrees(FVector(Values[0], Values[1], Values[2]));
+				}
+				break;
+
+			default:
+				break;
+			}
+		}
+		else if (BoneNameMappings != nullptr)
+		{
+			for (const TPair<UMultiverseAnim *, FName> &BoneNameMapping : *BoneNameMappings)
+			{
+				const int32 JointIndex = BoneNameMapping.Key->GetJointIndex(BoneNameMapping.Value);
+				if (JointIndex == INDEX_NONE)
+				{
+					continue;
+				}
+
+				switch (ResponseAttribute.Attribute)
+				{
+				case EAttribute::JointAngularPosition:
+					BoneNameMapping.Key->EditJointPose(JointIndex).SetRotation(FQuat(FRotator(Values[0], 0.f, 0.f)));
+					break;
+
+				case EAttribute::JointLinearPosition:
+					BoneNameMapping.Key->EditJointPose(JointIndex).SetTranslation(FVector(0.f, Values[0], 0.f));
+					break;
+
+				case EAttribute::JointPosition:
+					BoneNameMapping.Key->EditJointPose(JointIndex).SetTranslation(FVector(Values[0], Values[1], Values[2]));
+					break;
+
+				case EAttribute::JointQuaternion:
+					BoneNameMapping.Key->EditJointPose(JointIndex).SetRotation(FQuat(Values[1], Values[2], Values[3], Values[0]));
+					break;
+
+				default:
+					break;
+				}
+			}
+		}
+	}
+}
+
+void FMultiverseClient::bind_api_callbacks()
+{
+	if (DeferToGameThread([this]()
+						  { bind_api_callbacks(); }))
+	{
+		return;
+	}
+
+	if (!ResponseMetaDataJson->HasField(TEXT("api_callbacks")))
+	{
+		return;
+	}
+	for (const TSharedPtr<FJsonValue> &ApiCallbackJsonValue : ResponseMetaDataJson->GetArrayField(TEXT("api_callbacks")))
+	{
+		const TSharedPtr<FJsonObject> ApiCallbackJson = ApiCallbackJsonValue->AsObject();
+		for (const TPair<FString, TSharedPtr<FJsonValue>> &ApiCallbackPair : ApiCallbackJson->Values)
+		{
+			if (ApiCallbackPair.Key.Compare(TEXT("is_unreal")) == 0)
+			{
+				// UE_LOG(LogMultiverseClient, Log, TEXT("Received!"))
+			}
+		}
+	}
+}
+
+void FMultiverseClient::bind_api_callbacks_response()
+{
+	if (DeferToGameThread([this]()
+						  { bind_api_callbacks_response(); }))
+	{
+		return;
+	}
+
+	if (!ResponseMetaDataJson->HasField(TEXT("api_callbacks")))
+	{
+		return;
+	}
+	TArray<TSharedPtr<FJsonValue>> ApiCallbacksResponse;
+	for (const TSharedPtr<FJsonValue> &ApiCallbackJsonValue : ResponseMetaDataJson->GetArrayField(TEXT("api_callbacks")))
+	{
+		const TSharedPtr<FJsonObject> ApiCallbackResponseJson = MakeShareable(new FJsonObject);
+		for (const TPair<FString, TSharedPtr<FJsonValue>> &ApiCallbackPair : ApiCallbackJsonValue->AsObject()->Values)
+		{
+			if (ApiCallbackPair.Key.Compare(TEXT("is_unreal")) == 0)
+			{
+				ApiCallbackResponseJson->SetArrayField(ApiCallbackPair.Key, {MakeShareable(new FJsonValueString(TEXT("true")))});
 			}
 			else
 			{
-				switch (SendData.Value)
+				ApiCallbackResponseJson->SetArrayField(ApiCallbackPair.Key, {MakeShareable(new FJsonValueString(TEXT("not implemented")))});
+			}
+			ApiCallbacksResponse.Add(MakeShareable(new FJsonValueObject(ApiCallbackResponseJson)));
+		}
+	}
+	RequestMetaDataJson->SetArrayField(TEXT("api_callbacks_response"), ApiCallbacksResponse);
+}
+
+void FMultiverseClient::init_send_and_receive_data()
+{
+	if (DeferToGameThread([this]()
+						  { init_send_and_receive_data(); }))
+	{
+		return;
+	}
+
+	for (const TPair<AActor *, FAttributeContainer> &SendObject : SendObjects)
+	{
+		if (SendObject.Key == nullptr)
+		{
+			UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object in SendObjects"))
+			continue;
+		}
+
+		BindDataArray(SendDataArray, SendObject);
+	}
+
+	for (const TPair<AActor *, FAttributeContainer> &ReceiveObject : ReceiveObjects)
+	{
+		if (ReceiveObject.Key == nullptr)
+		{
+			UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object in ReceiveObjects"))
+			continue;
+		}
+
+		BindDataArray(ReceiveDataArray, ReceiveObject);
+	}
+
+	for (const TPair<FString, FAttributeDataContainer> &SendCustomObject : *SendCustomObjectsPtr)
+	{
+		BindDataArray(SendDataArray, SendCustomObject);
+	}
+
+	for (const TPair<FString, FAttributeDataContainer> &ReceiveCustomObject : *ReceiveCustomObjectsPtr)
+	{
+		BindDataArray(ReceiveDataArray, ReceiveCustomObject);
+	}
+
+	// The image encoders run on worker threads, what they need is loaded here
+	MultiverseImageEncoder::Initialize(Settings.ImageEncoding);
+
+	CompileBindings(SendDataArray, SendObjects, SendCustomObjectsPtr, SendBindings);
+	CompileBindings(ReceiveDataArray, ReceiveObjects, ReceiveCustomObjectsPtr, ReceiveBindings);
+	CompileTransformBindings(ReceiveBindings, ReceiveTransformBindings);
+	CompileAnimBindings(ReceiveBindings, ReceiveAnimBindings);
+	if (Settings.bPhysicsStepCommunication)
+	{
+		CompilePhysicsBindings(SendBindings, SendPhysicsBindings, false);
+		CompilePhysicsBindings(ReceiveBindings, ReceivePhysicsBindings, true);
+		PublishPhysicsBindings();
+		if (PhysicsStepCallback == nullptr)
+		{
+			RegisterPhysicsStepCallback();
+		}
+	}
+	CompileInterpolationSlots();
+	CompileCaptureSchedule();
+
+	bSendAndReceiveDataBound = true;
+}
+
+double FMultiverseClient::ComputeWorldTime() const
+{
+	// In lockstep the world is exactly at the server time it was advanced to
+	if (Settings.bLockstep && LockstepServerTime >= 0.0)
+	{
+		return LockstepServerTime;
+	}
+	return ComputeLocalTime();
+}
+
+double FMultiverseClient::ComputeLocalTime() const
+{
+	return FMath::Max(FPlatformTime::Seconds() - StartTime, 0.0);
+}
+
+double FMultiverseClient::ComputeServerTime() const
+{
+	return ClockEstimator.ToServerTime(ComputeLocalTime());
+}
+
+void FMultiverseClient::bind_send_data()
+{
+	ExchangeSendTime = ComputeLocalTime();
+	if (IsExchangeThread())
+	{
+		if (SendSnapshots.IsDirty())
+		{
+			SendSnapshots.SwapReadBuffers();
+		}
+
+		// A snapshot gathered before a re-handshake does not match the new layout, resend the previous data instead
+		const FMultiverseBufferSnapshot &SendSnapshot = SendSnapshots.Read();
+		if (SendSnapshot.BufferDouble.Num() == send_buffer.buffer_double.size &&
+			SendSnapshot.BufferUint8.Num() == send_buffer.buffer_uint8_t.size &&
+			SendSnapshot.BufferUint16.Num() == send_buffer.buffer_uint16_t.size)
+		{
+			*world_time = SendSnapshot.WorldTime;
+			FMemory::Memcpy(send_buffer.buffer_double.data, SendSnapshot.BufferDouble.GetData(), send_buffer.buffer_double.size * sizeof(double));
+			FMemory::Memcpy(send_buffer.buffer_uint8_t.data, SendSnapshot.BufferUint8.GetData(), send_buffer.buffer_uint8_t.size * sizeof(uint8_t));
+			FMemory::Memcpy(send_buffer.buffer_uint16_t.data, SendSnapshot.BufferUint16.GetData(), send_buffer.buffer_uint16_t.size * sizeof(uint16_t));
+		}
+
+		// The bodies are sampled in every substep, the rest is the data of the last frame
+		if (IsPhysicsStepThread())
+		{
+			*world_time = ComputeWorldTime();
+			GatherPhysicsSendData(send_buffer.buffer_double.data);
+		}
+		return;
+	}
+
+	*world_time = ComputeWorldTime();
+	GatherSendData(send_buffer.buffer_double.data, send_buffer.buffer_uint8_t.data, send_buffer.buffer_uint16_t.data);
+}
+
+void FMultiverseClient::GatherSendData(double *SendBufferDoubleAddr, uint8_t *SendBufferUint8Addr, uint16_t *SendBufferUint16Addr)
+{
+	// Every binding writes its own slice of the buffers, the transforms are read in parallel and the rest on the game thread
+	const EParallelForFlags ParallelForFlags = SendBindings.Num() < Settings.ParallelGatherThreshold ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None;
+	ParallelFor(SendBindings.Num(), [&](const int32 Index)
+				{
+					if (CanGatherInParallel(SendBindings[Index]))
+					{
+						GatherSendBinding(SendBindings[Index], SendBufferDoubleAddr, SendBufferUint8Addr, SendBufferUint16Addr);
+					}
+				},
+				ParallelForFlags);
+
+	CaptureScheduler.Schedule(ComputeWorldTime(), DueCaptures);
+	for (const FMultiverseBinding &SendBinding : SendBindings)
+	{
+		if (!CanGatherInParallel(SendBinding))
+		{
+			GatherSendBinding(SendBinding, SendBufferDoubleAddr, SendBufferUint8Addr, SendBufferUint16Addr);
+		}
+	}
+}
+
+void FMultiverseClient::GatherSendBinding(const FMultiverseBinding &SendBinding, double *SendBufferDoubleAddr, uint8_t *SendBufferUint8Addr, uint16_t *SendBufferUint16Addr) const
+{
+	double *DoubleAddr = SendBufferDoubleAddr + SendBinding.DoubleOffset;
+	switch (SendBinding.Type)
+	{
+	case EMultiverseBindingType::CustomObject:
+	{
+		const int32 DataSize = FMath::Min(SendBinding.CustomData->Data.Num(), AttributeDoubleDataMap[SendBinding.Attribute].Num());
+		FMemory::Memcpy(DoubleAddr, SendBinding.CustomData->Data.GetData(), DataSize * sizeof(double));
+		break;
+	}
+
+	case EMultiverseBindingType::Actor:
+	{
+		switch (SendBinding.Attribute)
+		{
+		case EAttribute::Position:
+			WriteVector(DoubleAddr, SendBinding.Actor->GetActorLocation());
+			break;
+
+		case EAttribute::Quaternion:
+			WriteQuat(DoubleAddr, SendBinding.Actor->GetActorQuat());
+			break;
+
+		case EAttribute::LinearVelocity:
+			if (SendBinding.PrimitiveComponent != nullptr)
+			{
+				WriteVector(DoubleAddr, SendBinding.PrimitiveComponent->GetPhysicsLinearVelocity());
+			}
+			break;
+
+		case EAttribute::AngularVelocity:
+			if (SendBinding.PrimitiveComponent != nullptr)
+			{
+				WriteVector(DoubleAddr, SendBinding.PrimitiveComponent->GetPhysicsAngularVelocityInDegrees());
+			}
+			break;
+
+		default:
+			break;
+		}
+		break;
+	}
+
+	case EMultiverseBindingType::SceneComponent:
+	{
+		if (SendBinding.Attribute == EAttribute::Position)
+		{
+			WriteVector(DoubleAddr, SendBinding.SceneComponent->GetComponentLocation());
+		}
+		else if (SendBinding.Attribute == EAttribute::Quaternion)
+		{
+			WriteQuat(DoubleAddr, SendBinding.SceneComponent->GetComponentQuat());
+		}
+		break;
+	}
+
+	case EMultiverseBindingType::SceneCapture:
+	{
+		UTextureRenderTarget2D *TextureTarget = SendBinding.SceneCaptureComponent->TextureTarget;
+		if (TextureTarget == nullptr)
+		{
+			break;
+		}
+
+		const bool bIsRGB = !IsDepthAttribute(SendBinding.Attribute);
+		uint8_t *Uint8Addr = SendBufferUint8Addr + SendBinding.Uint8Offset;
+		uint16_t *Uint16Addr = SendBufferUint16Addr + SendBinding.Uint16Offset;
+		// Between captures the latest frame is sent again
+		const bool bCapture = DueCaptures.IsValidIndex(SendBinding.CaptureIndex) && DueCaptures[SendBinding.CaptureIndex];
+		if (bCapture)
+		{
+			SendBinding.SceneCaptureComponent->CaptureScene();
+		}
+		SendBinding.CameraReadback->Update(TextureTarget, ComputeWorldTime(), bCapture);
+		const FMultiverseCameraFrame *Frame = &SendBinding.CameraReadback->GetLatestFrame();
+
+		const int DataSize = TextureTarget->SizeX * TextureTarget->SizeY;
+		const int ExpectedDataSize = SendBinding.ImageSize.X * SendBinding.ImageSize.Y;
+		if (Frame->Pixels.Num() == 0)
+		{
+			// No readback has completed yet, send a black image rather than stale memory, an encoded slot is then empty
+			if (DataSize == ExpectedDataSize && bIsRGB)
+			{
+				FMemory::Memzero(Uint8Addr, SendBinding.ImageSlotSize * sizeof(uint8_t));
+			}
+			else if (DataSize == ExpectedDataSize)
+			{
+				FMemory::Memzero(Uint16Addr, SendBinding.ImageSlotSize * sizeof(uint16_t));
+			}
+		}
+		else if (DataSize != ExpectedDataSize || Frame->Width * Frame->Height != DataSize)
+		{
+			UE_LOG(LogMultiverseClient, Warning, TEXT("DataSize %d != ExpectedDataSize %d"), DataSize, ExpectedDataSize)
+		}
+		else
+		{
+			WriteCameraFrame(*Frame, bIsRGB ? Uint8Addr : nullptr, bIsRGB ? nullptr : Uint16Addr, SendBinding.ImageSlotSize);
+		}
+		break;
+	}
+
+	case EMultiverseBindingType::Bone:
+	{
+		const FMultiverseAnimJoint &Joint = SendBinding.Joints[0];
+		if (SendBinding.Attribute == EAttribute::JointAngularPosition)
+		{
+			const FQuat JointQuaternion = Joint.Anim->GetJointPose(Joint.JointIndex).GetRotation();
+			*DoubleAddr = FMath::RadiansToDegrees(JointQuaternion.GetAngle());
+		}
+		else if (SendBinding.Attribute == EAttribute::JointLinearPosition)
+		{
+			const FVector JointPosition = Joint.Anim->GetJointPose(Joint.JointIndex).GetTranslation();
+			*DoubleAddr = JointPosition.Y;
+		}
+		else if (SendBinding.Attribute == EAttribute::JointPosition)
+		{
+			WriteVector(DoubleAddr, Joint.Anim->GetJointPose(Joint.JointIndex).GetTranslation());
+		}
+		else if (SendBinding.Attribute == EAttribute::JointQuaternion)
+		{
+			WriteQuat(DoubleAddr, Joint.Anim->GetJointPose(Joint.JointIndex).GetRotation());
+		}
+		break;
+	}
+
+#ifdef WIN32
+	case EMultiverseBindingType::HandBone:
+	{
+		UOculusXRHandComponent *OculusXRHandComponent = Cast<UOculusXRHandComponent>(SendBinding.SceneComponent);
+		if (SendBinding.Attribute == EAttribute::Position)
+		{
+			WriteVector(DoubleAddr, OculusXRHandComponent->GetBoneLocationByName(SendBinding.BoneName, EBoneSpaces::WorldSpace));
+		}
+		else if (SendBinding.Attribute == EAttribute::Quaternion)
+		{
+			WriteQuat(DoubleAddr, OculusXRHandComponent->GetBoneRotationByName(SendBinding.BoneName, EBoneSpaces::WorldSpace).Quaternion());
+		}
+		break;
+	}
+#endif
+
+	default:
+		break;
+	}
+}
+
+void FMultiverseClient::bind_receive_data()
+{
+	ClockEstimator.AddSample(ExchangeSendTime, *world_time, ComputeLocalTime());
+	if (IsExchangeThread())
+	{
+		if (IsPhysicsStepThread())
+		{
+			ApplyPhysicsReceiveData(receive_buffer.buffer_double.data);
+		}
+
+		FMultiverseBufferSnapshot &ReceiveSnapshot = ReceiveSnapshots.GetWriteBuffer();
+		ReceiveSnapshot.BufferDouble.SetNumUninitialized(receive_buffer.buffer_double.size);
+		FMemory::Memcpy(ReceiveSnapshot.BufferDouble.GetData(), receive_buffer.buffer_double.data, receive_buffer.buffer_double.size * sizeof(double));
+		ReceiveSnapshot.WorldTime = *world_time;
+		ReceiveSnapshots.SwapWriteBuffers();
+		return;
+	}
+
+	ReceiveJitterBuffer.Push(*world_time, receive_buffer.buffer_double.data, receive_buffer.buffer_double.size);
+	ApplyReceiveData(receive_buffer.buffer_double.data);
+}
+
+void FMultiverseClient::ApplyReceiveData(const double *ReceiveBufferDoubleAddr)
+{
+	// With interpolation the poses are applied every frame by UpdateInterpolation instead
+	if (!Settings.bInterpolateReceiveData)
+	{
+		ApplyReceivePoses(ReceiveBufferDoubleAddr);
+	}
+
+	for (const FMultiverseBinding &ReceiveBinding : ReceiveBindings)
+	{
+		const double *DoubleAddr = ReceiveBufferDoubleAddr + ReceiveBinding.DoubleOffset;
+		switch (ReceiveBinding.Type)
+		{
+		case EMultiverseBindingType::CustomObject:
+		{
+			const int32 DataSize = FMath::Min(ReceiveBinding.CustomData->Data.Num(), AttributeDoubleDataMap[ReceiveBinding.Attribute].Num());
+			FMemory::Memcpy(ReceiveBinding.CustomData->Data.GetData(), DoubleAddr, DataSize * sizeof(double));
+			break;
+		}
+
+		case EMultiverseBindingType::Actor:
+		{
+			if (ReceiveBinding.bPhysicsStep)
+			{
+				break;
+			}
+
+			switch (ReceiveBinding.Attribute)
+			{
+			case EAttribute::LinearVelocity:
+				if (ReceiveBinding.PrimitiveComponent != nullptr)
 				{
-				case EAttribute::Position:
+					ReceiveBinding.PrimitiveComponent->SetPhysicsLinearVelocity(ReadVector(DoubleAddr));
+				}
+				break;
+
+			case EAttribute::AngularVelocity:
+				if (ReceiveBinding.PrimitiveComponent != nullptr)
 				{
-					const FVector ActorLocation = CachedActors[SendData.Key]->GetActorLocation();
-					*send_buffer_double_addr++ = ActorLocation.X;
-					*send_buffer_double_addr++ = ActorLocation.Y;
-					*send_buffer_double_addr++ = ActorLocation.Z;
-					break;
+					ReceiveBinding.PrimitiveComponent->SetPhysicsAngularVelocityInDegrees(ReadVector(DoubleAddr));
+				}
+				break;
+
+			case EAttribute::Force:
+				if (ReceiveBinding.PrimitiveComponent != nullptr)
+				{
+					ReceiveBinding.PrimitiveComponent->AddForce(ReadVector(DoubleAddr));
+				}
+				break;
+
+			case EAttribute::Torque:
+				if (ReceiveBinding.PrimitiveComponent != nullptr)
+				{
+					ReceiveBinding.PrimitiveComponent->AddTorqueInRadians(ReadVector(DoubleAddr));
 				}
+				break;
+
+			default:
+				break;
+			}
+			break;
+		}
+
+		default:
+			break;
+		}
+	}
+}
+
+void FMultiverseClient::ApplyReceivePoses(const double *ReceiveBufferDoubleAddr)
+{
+	// Position and quaternion of an actor are applied together, before velocities so that TeleportPhysics keeps them
+	for (const FMultiverseTransformBinding &TransformBinding : ReceiveTransformBindings)
+	{
+		AActor *Actor = TransformBinding.Actor;
+		if (Actor->GetRootComponent() == nullptr)
+		{
+			continue;
+		}
+
+		FScopedMovementUpdate ScopedMovementUpdate(Actor->GetRootComponent(), EScopedUpdate::DeferredUpdates);
+		const FVector Location = TransformBinding.PositionOffset != INDEX_NONE ? ReadVector(ReceiveBufferDoubleAddr + TransformBinding.PositionOffset) : Actor->GetActorLocation();
+		const FQuat Rotation = TransformBinding.QuaternionOffset != INDEX_NONE ? ReadQuat(ReceiveBufferDoubleAddr + TransformBinding.QuaternionOffset) : Actor->GetActorQuat();
+		Actor->SetActorLocationAndRotation(Location, Rotation, false, nullptr, Settings.ReceiveTeleportType);
+	}
+
+	for (const FMultiverseAnimBinding &AnimBinding : ReceiveAnimBindings)
+	{
+		TArrayView<FTransform> JointPoses = AnimBinding.Anim->EditJointPoses();
+		for (const FMultiverseJointBinding &JointBinding : AnimBinding.Joints)
+		{
+			FTransform &JointPose = JointPoses[JointBinding.JointIndex];
+			const double *DoubleAddr = ReceiveBufferDoubleAddr + JointBinding.DoubleOffset;
+			switch (JointBinding.Attribute)
+			{
+			case EAttribute::JointAngularPosition:
+				JointPose.SetRotation(FQuat(FRotator(*DoubleAddr, 0.f, 0.f)));
+				break;
+
+			case EAttribute::JointLinearPosition:
+				JointPose.SetTranslation(FVector(0.f, *DoubleAddr, 0.f));
+				break;
+
+			case EAttribute::JointPosition:
+				JointPose.SetTranslation(ReadVector(DoubleAddr));
+				break;
+
+			case EAttribute::JointQuaternion:
+				JointPose.SetRotation(ReadQuat(DoubleAddr));
+				break;
+
+			default:
+				break;
+			}
+		}
+	}
+}
+
+void FMultiverseClient::UpdateInterpolation()
+{
+	if (!Settings.bInterpolateReceiveData || !bSendAndReceiveDataBound)
+	{
+		return;
+	}
+
+	// The samples are keyed on the server time, the render time is the local clock moved onto it by the measured offset
+	const double RenderTime = ComputeServerTime() - Settings.InterpolationDelay;
+	if (ReceiveJitterBuffer.Sample(RenderTime, Settings.MaxExtrapolationTime, ReceiveInterpolationSlots, InterpolatedReceiveData) &&
+		InterpolatedReceiveData.Num() == receive_buffer.buffer_double.size)
+	{
+		ApplyReceivePoses(InterpolatedReceiveData.GetData());
+	}
+}
+
+void FMultiverseClient::CompilePhysicsBindings(TArray<FMultiverseBinding> &Bindings, TArray<FMultiversePhysicsBinding> &PhysicsBindings, bool bReceive) const
+{
+	PhysicsBindings.Reset();
+	for (FMultiverseBinding &Binding : Bindings)
+	{
+		if (Binding.Type != EMultiverseBindingType::Actor || Binding.PrimitiveComponent == nullptr)
+		{
+			continue;
+		}
+
+		const bool bPhysicsAttribute = bReceive ? Binding.Attribute == EAttribute::LinearVelocity || Binding.Attribute == EAttribute::AngularVelocity ||
+													  Binding.Attribute == EAttribute::Force || Binding.Attribute == EAttribute::Torque
+												: Binding.Attribute == EAttribute::Position || Binding.Attribute == EAttribute::Quaternion ||
+													  Binding.Attribute == EAttribute::LinearVelocity || Binding.Attribute == EAttribute::AngularVelocity;
+		const FBodyInstance *BodyInstance = Binding.PrimitiveComponent->GetBodyInstance();
+		if (!bPhysicsAttribute || BodyInstance == nullptr || BodyInstance->GetPhysicsActorHandle() == nullptr)
+		{
+			continue;
+		}
+
+		FMultiversePhysicsBinding &PhysicsBinding = PhysicsBindings.AddDefaulted_GetRef();
+		PhysicsBinding.Actor = Binding.Actor;
+		PhysicsBinding.Component = Binding.PrimitiveComponent;
+		PhysicsBinding.Attribute = Binding.Attribute;
+		PhysicsBinding.DoubleOffset = Binding.DoubleOffset;
+		Binding.bPhysicsStep = bReceive;
+	}
+}
+
+void FMultiverseClient::CompileInterpolationSlots()
+{
+	ReceiveInterpolationSlots.Reset();
+	for (const FMultiverseTransformBinding &TransformBinding : ReceiveTransformBindings)
+	{
+		if (TransformBinding.PositionOffset != INDEX_NONE)
+		{
+			ReceiveInterpolationSlots.Add({TransformBinding.PositionOffset, 3, EMultiverseInterpolation::Linear});
+		}
+		if (TransformBinding.QuaternionOffset != INDEX_NONE)
+		{
+			ReceiveInterpolationSlots.Add({TransformBinding.QuaternionOffset, 4, EMultiverseInterpolation::Quaternion});
+		}
+	}
+	for (const FMultiverseBinding &ReceiveBinding : ReceiveBindings)
+	{
+		if (ReceiveBinding.Type != EMultiverseBindingType::Bone)
+		{
+			continue;
+		}
 
-				case EAttribute::Quaternion:
-				{
-					const FQuat ActorQuat = CachedActors[SendData.Key]->GetActorQuat();
-					*send_buffer_double_addr++ = ActorQuat.W;
-					*send_buffer_double_addr++ = ActorQuat.X;
-					*send_buffer_double_addr++ = ActorQuat.Y;
-					*send_buffer_double_addr++ = ActorQuat.Z;
-					break;
-				}
+		switch (ReceiveBinding.Attribute)
+		{
+		case EAttribute::JointAngularPosition:
+			ReceiveInterpolationSlots.Add({ReceiveBinding.DoubleOffset, 1, EMultiverseInterpolation::AngleDegrees});
+			break;
 
-				case EAttribute::LinearVelocity:
-				{
-					const FVector ActorLinearVelocity = Cast<UPrimitiveComponent>(CachedActors[SendData.Key]->GetRootComponent())->GetPhysicsLinearVelocity();
-					*send_buffer_double_addr++ = ActorLinearVelocity.X;
-					*send_buffer_double_addr++ = ActorLinearVelocity.Y;
-					*send_buffer_double_addr++ = ActorLinearVelocity.Z;
-					break;
-				}
+		case EAttribute::JointLinearPosition:
+			ReceiveInterpolationSlots.Add({ReceiveBinding.DoubleOffset, 1, EMultiverseInterpolation::Linear});
+			break;
 
-				case EAttribute::AngularVelocity:
-				{
-					const FVector ActorAngularVelocity = Cast<UPrimitiveComponent>(CachedActors[SendData.Key]->GetRootComponent())->GetPhysicsAngularVelocityInDegrees();
-					*send_buffer_double_addr++ = ActorAngularVelocity.X;
-					*send_buffer_double_addr++ = ActorAngularVelocity.Y;
-					*send_buffer_double_addr++ = ActorAngularVelocity.Z;
-					break;
-				}
+		case EAttribute::JointPosition:
+			ReceiveInterpolationSlots.Add({ReceiveBinding.DoubleOffset, 3, EMultiverseInterpolation::Linear});
+			break;
+
+		case EAttribute::JointQuaternion:
+			ReceiveInterpolationSlots.Add({ReceiveBinding.DoubleOffset, 4, EMultiverseInterpolation::Quaternion});
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	ReceiveJitterBuffer.Reset(Settings.JitterBufferSize);
+}
+
+void FMultiverseClient::CompileCaptureSchedule()
+{
+	CaptureScheduler.Reset(Settings.MaxCapturesPerFrame);
+	for (FMultiverseBinding &SendBinding : SendBindings)
+	{
+		if (SendBinding.Type != EMultiverseBindingType::SceneCapture)
+		{
+			continue;
+		}
+
+		// The scheduler decides when the camera renders
+		SendBinding.SceneCaptureComponent->bCaptureEveryFrame = false;
+		SendBinding.SceneCaptureComponent->bCaptureOnMovement = false;
+		SendBinding.CaptureIndex = CaptureScheduler.AddCamera(SendBinding.CaptureRate);
+	}
+}
+
+void FMultiverseClient::CompileBindings(const TArray<TPair<FString, EAttribute>> &DataArray,
+										const TMap<AActor *, FAttributeContainer> &Objects,
+										TMap<FString, FAttributeDataContainer> *CustomObjectsPtr,
+										TArray<FMultiverseBinding> &Bindings) const
+{
+	Bindings.Reset(DataArray.Num());
+
+	int32 DoubleOffset = 0;
+	int32 Uint8Offset = 0;
+	int32 Uint16Offset = 0;
+	for (const TPair<FString, EAttribute> &Data : DataArray)
+	{
+		FMultiverseBinding &Binding = Bindings.AddDefaulted_GetRef();
+		Binding.Attribute = Data.Value;
+		Binding.DoubleOffset = DoubleOffset;
+		Binding.Uint8Offset = Uint8Offset;
+		Binding.Uint16Offset = Uint16Offset;
+
+		// Camera attributes take their size from the sensor descriptor of the object
+		FMultiverseSensorDescriptor Sensor;
+		if (IsSensorAttribute(Data.Value))
+		{
+			AActor *const *SensorActor = CachedActors.Find(Data.Key);
+			Sensor = GetSensorDescriptor(Data.Value, SensorActor != nullptr ? Objects.Find(*SensorActor) : nullptr);
+			Binding.ImageSize = FIntPoint(Sensor.Width, Sensor.Height);
+		}
+
+		// Keep the offsets of unresolved entries so that the following entries stay aligned with the buffer layout
+		if (const TArray<double> *AttributeDoubleData = AttributeDoubleDataMap.Find(Data.Value))
+		{
+			DoubleOffset += AttributeDoubleData->Num();
+		}
+		else if (IsSensorAttribute(Data.Value) && IsDepthAttribute(Data.Value))
+		{
+			Binding.ImageSlotSize = GetImageSlotSize(Sensor.Width * Sensor.Height, sizeof(uint16), Settings);
+			Uint16Offset += Binding.ImageSlotSize;
+		}
+		else if (IsSensorAttribute(Data.Value))
+		{
+			Binding.ImageSlotSize = GetImageSlotSize(Sensor.Width * Sensor.Height * 3, sizeof(uint8), Settings);
+			Uint8Offset += Binding.ImageSlotSize;
+		}
+
+		if (FAttributeDataContainer *CustomObject = CustomObjectsPtr->Find(Data.Key))
+		{
+			if ((Binding.CustomData = CustomObject->Attributes.Find(Data.Value)) != nullptr)
+			{
+				Binding.Type = EMultiverseBindingType::CustomObject;
+			}
+		}
+		else if (AActor *const *CachedActor = CachedActors.Find(Data.Key))
+		{
+			if (*CachedActor == nullptr)
+			{
+				UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object in CachedActors"))
+				continue;
+			}
 
-				case EAttribute::RGB_3840_2160:
-				case EAttribute::RGB_1280_1024:
-				case EAttribute::RGB_640_480:
-				case EAttribute::RGB_128_128:
-				case EAttribute::Depth_3840_2160:
-				case EAttribute::Depth_1280_1024:
-				case EAttribute::Depth_640_480:
-				case EAttribute::Depth_128_128:
+			Binding.Actor = *CachedActor;
+			Binding.PrimitiveComponent = Cast<UPrimitiveComponent>(Binding.Actor->GetRootComponent());
+			switch (Data.Value)
+			{
+			case EAttribute::RGB:
+			case EAttribute::RGB_3840_2160:
+			case EAttribute::RGB_1280_1024:
+			case EAttribute::RGB_640_480:
+			case EAttribute::RGB_128_128:
+			case EAttribute::Depth:
+			case EAttribute::Depth_3840_2160:
+			case EAttribute::Depth_1280_1024:
+			case EAttribute::Depth_640_480:
+			case EAttribute::Depth_128_128:
+			{
+				TArray<USceneCaptureComponent2D *> SceneCaptureComponents;
+				Binding.Actor->GetComponents(SceneCaptureComponents);
+				const FName AttributeName = *GetSensorAttributeName(Data.Value, Sensor);
+				for (USceneCaptureComponent2D *SceneCaptureComponent : SceneCaptureComponents)
 				{
-					TArray<USceneCaptureComponent2D *> SceneCaptureComponents;
-					CachedActors[SendData.Key]->GetComponents(SceneCaptureComponents);
-					const FString AttributeName = *AttributeStringMap.FindKey(SendData.Value);
-					for (USceneCaptureComponent2D *SceneCaptureComponent : SceneCaptureComponents)
+					if (SceneCaptureComponent->ComponentTags.Contains(AttributeName))
 					{
-						if (!SceneCaptureComponent->ComponentTags.Contains(*AttributeName) || SceneCaptureComponent->TextureTarget == nullptr)
-						{
-							continue;
-						}
-						FTextureRenderTargetResource *TextureRenderTargetResource = SceneCaptureComponent->TextureTarget->GameThread_GetRenderTargetResource();
-						TArray<FColor> ColorArray;
-						FReadSurfaceDataFlags ReadSurfaceDataFlags;
-						ReadSurfaceDataFlags.SetLinearToGamma(false);
-						TextureRenderTargetResource->ReadPixels(ColorArray, ReadSurfaceDataFlags);
-
-						const int DataSize = SceneCaptureComponent->TextureTarget->SizeX * SceneCaptureComponent->TextureTarget->SizeY;
-						const int ExpectedDataSize = AttributeUint8DataMap.Contains(SendData.Value) ? AttributeUint8DataMap[SendData.Value].Num() / 3 : AttributeUint16DataMap[SendData.Value].Num();
-						if (DataSize != ExpectedDataSize)
-						{
-							UE_LOG(LogMultiverseClient, Warning, TEXT("DataSize %d != ExpectedDataSize %d"), 3 * DataSize, ExpectedDataSize)
-						}
-						else
+						Binding.Type = EMultiverseBindingType::SceneCapture;
+						Binding.SceneCaptureComponent = SceneCaptureComponent;
+						Binding.CaptureRate = Sensor.CaptureRate;
+						Binding.CameraReadback = MakeShared<FMultiverseCameraReadback, ESPMode::ThreadSafe>(Settings.CameraReadbackRingSize, Settings.bAsyncCameraReadback && FMultiverseCameraReadback::IsSupported());
+						const EMultiverseImageEncoding Encoding = Settings.ImageEncoding;
+						const int32 Quality = Settings.ImageEncodingQuality;
+						if (IsDepthAttribute(Data.Value))
 						{
-							if (SendData.Value == EAttribute::RGB_3840_2160 || SendData.Value == EAttribute::RGB_1280_1024 || SendData.Value == EAttribute::RGB_640_480 || SendData.Value == EAttribute::RGB_128_128)
-							{
-								for (int i = 0; i < DataSize; i++)
+							// With asynchronous readbacks full precision depth is converted on a worker thread, the game thread only copies the result
+							Binding.CameraReadback->SetFrameProcessor([DepthConversion = Settings.DepthConversion, Encoding, Quality](const FMultiverseCameraFrame &Frame, FMultiverseCameraFrame &OutFrame)
+																	  {
+								if (Encoding == EMultiverseImageEncoding::None)
 								{
-									*send_buffer_uint8_addr++ = ColorArray[i].R;
-									*send_buffer_uint8_addr++ = ColorArray[i].G;
-									*send_buffer_uint8_addr++ = ColorArray[i].B;
+									ConvertDepthFrame(Frame, OutFrame, DepthConversion);
+									return;
 								}
-							}
-							else if (SendData.Value == EAttribute::Depth_3840_2160 || SendData.Value == EAttribute::Depth_1280_1024 || SendData.Value == EAttribute::Depth_640_480 || SendData.Value == EAttribute::Depth_128_128)
-							{
-								for (int i = 0; i < DataSize; i++)
-								{
-									*send_buffer_uint16_addr++ = ColorArray[i].R;
-								}
-							}
+								FMultiverseCameraFrame DepthFrame;
+								ConvertDepthFrame(Frame, DepthFrame, DepthConversion);
+								EncodeCameraFrame(DepthFrame, OutFrame, Encoding, Quality); });
+						}
+						else if (Encoding != EMultiverseImageEncoding::None)
+						{
+							// Encoding overlaps with the capture of the next frame
+							Binding.CameraReadback->SetFrameProcessor([Encoding, Quality](const FMultiverseCameraFrame &Frame, FMultiverseCameraFrame &OutFrame)
+																	  { EncodeCameraFrame(Frame, OutFrame, Encoding, Quality); });
 						}
+						break;
 					}
-					break;
-				}
-
-				default:
-					break;
 				}
+				break;
 			}
-		}
-		else if (CachedBoneNames.Contains(SendData.Key))
-		{
-			switch (SendData.Value)
-			{
-			case EAttribute::JointAngularPosition:
+
+			default:
 			{
-				for (TPair<UMultiverseAnim *, FName> &BoneNameMapping : CachedBoneNames[SendData.Key])
+				if (Data.Key.Compare(TEXT("PlayerPawn")) != 0)
 				{
-					const FQuat JointQuaternion = BoneNameMapping.Key->JointPoses[BoneNameMapping.Value].GetRotation();
-					*send_buffer_double_addr++ = FMath::RadiansToDegrees(JointQuaternion.GetAngle());
+					Binding.Type = EMultiverseBindingType::Actor;
 					break;
 				}
-				break;
-			}
 
-			case EAttribute::JointLinearPosition:
-			{
-				for (TPair<UMultiverseAnim *, FName> &BoneNameMapping : CachedBoneNames[SendData.Key])
+				APawn *PlayerPawn = UGameplayStatics::GetPlayerPawn(World, 0);
+				const FString Tag = TEXT("Head");
+				TArray<UActorComponent *> ActorComponents = PlayerPawn != nullptr ? PlayerPawn->GetComponentsByTag(UCameraComponent::StaticClass(), *Tag) : TArray<UActorComponent *>();
+				if (ActorComponents.Num() != 1)
 				{
-					const FVector JointPosition = BoneNameMapping.Key->JointPoses[BoneNameMapping.Value].GetTranslation();
-					*send_buffer_double_addr++ = JointPosition.Y;
+					UE_LOG(LogMultiverseClient, Warning, TEXT("Found %d %s"), ActorComponents.Num(), *Tag)
 					break;
 				}
+				Binding.Type = EMultiverseBindingType::SceneComponent;
+				Binding.SceneComponent = Cast<USceneComponent>(ActorComponents[0]);
 				break;
 			}
-
-			default:
-				break;
 			}
 		}
-		else
+		else if (const TMap<UMultiverseAnim *, FName> *BoneNameMappings = CachedBoneNames.Find(Data.Key))
 		{
-			if (CachedComponents.Contains(SendData.Key))
+			// Joints are written by index into the joint state of the anim instances, the names are resolved once here
+			for (const TPair<UMultiverseAnim *, FName> &BoneNameMapping : *BoneNameMappings)
 			{
-				if (UCameraComponent *CameraComponent = Cast<UCameraComponent>(CachedComponents[SendData.Key]))
+				if (const int32 JointIndex = BoneNameMapping.Key->GetJointIndex(BoneNameMapping.Value); JointIndex != INDEX_NONE)
 				{
-					if (SendData.Value == EAttribute::Position)
-					{
-						const FVector CameraLocation = CameraComponent->GetComponentLocation();
-						*send_buffer_double_addr++ = CameraLocation.X;
-						*send_buffer_double_addr++ = CameraLocation.Y;
-						*send_buffer_double_addr++ = CameraLocation.Z;
-					}
-					else if (SendData.Value == EAttribute::Quaternion)
-					{
-						const FQuat CameraQuat = CameraComponent->GetComponentQuat();
-						*send_buffer_double_addr++ = CameraQuat.W;
-						*send_buffer_double_addr++ = CameraQuat.X;
-						*send_buffer_double_addr++ = CameraQuat.Y;
-						*send_buffer_double_addr++ = CameraQuat.Z;
-					}
-				}
-				else if (USkeletalMeshComponent *SkeletalMeshComponent = Cast<USkeletalMeshComponent>(CachedComponents[SendData.Key]))
-				{
-					if (SendData.Value == EAttribute::Position)
-					{
-						const FVector HandLocation = SkeletalMeshComponent->GetComponentLocation();
-						*send_buffer_double_addr++ = HandLocation.X;
-						*send_buffer_double_addr++ = HandLocation.Y;
-						*send_buffer_double_addr++ = HandLocation.Z;
-					}
-					else if (SendData.Value == EAttribute::Quaternion)
-					{
-						const FQuat HandQuat = SkeletalMeshComponent->GetComponentQuat();
-						*send_buffer_double_addr++ = HandQuat.W;
-						*send_buffer_double_addr++ = HandQuat.X;
-						*send_buffer_double_addr++ = HandQuat.Y;
-						*send_buffer_double_addr++ = HandQuat.Z;
-					}
-				}
-				else
-				{
-					UE_LOG(LogMultiverseClient, Error, TEXT("This should not happen"))
+					Binding.Joints.Add({BoneNameMapping.Key, JointIndex, BoneNameMapping.Key->GetOwningActor()});
 				}
 			}
-
+			if (Binding.Joints.Num() > 0)
+			{
+				Binding.Type = EMultiverseBindingType::Bone;
+			}
+		}
+		else if (UActorComponent *const *CachedComponent = CachedComponents.Find(Data.Key))
+		{
+			if ((Binding.SceneComponent = Cast<USceneComponent>(*CachedComponent)) != nullptr)
+			{
+				Binding.Type = EMultiverseBindingType::SceneComponent;
+			}
+		}
 #ifdef WIN32
-			APawn *PlayerPawn = UGameplayStatics::GetPlayerPawn(World, 0);
+		else if (APawn *PlayerPawn = UGameplayStatics::GetPlayerPawn(World, 0))
+		{
 			for (const FString &Tag : {TEXT("LeftHand"), TEXT("RightHand")})
 			{
-				if (SendData.Key.Contains(Tag))
+				if (!Data.Key.Contains(Tag))
 				{
-					TArray<UActorComponent *> ActorComponents = PlayerPawn->GetComponentsByTag(UOculusXRHandComponent::StaticClass(), *Tag);
-					if (ActorComponents.Num() != 1)
-					{
-						UE_LOG(LogMultiverseClient, Warning, TEXT("Found %d %s"), ActorComponents.Num(), *Tag)
-						continue;
-					}
-					UOculusXRHandComponent *OculusXRHandComponent = Cast<UOculusXRHandComponent>(ActorComponents[0]);
+					continue;
+				}
 
-					const EOculusXRBone *Bone = OculusXRHandComponent->BoneNameMappings.FindKey(*SendData.Key);
-					if (Bone == nullptr)
-					{
-						UE_LOG(LogMultiverseClient, Warning, TEXT("Bone %s is nullptr"), *SendData.Key)
-						continue;
-					}
-					const FString BoneName = UEnum::GetDisplayValueAsText(*Bone).ToString();
-					if (SendData.Value == EAttribute::Position)
-					{
-						const FVector BoneLocation = OculusXRHandComponent->GetBoneLocationByName(*BoneName, EBoneSpaces::WorldSpace);
-						*send_buffer_double_addr++ = BoneLocation.X;
-						*send_buffer_double_addr++ = BoneLocation.Y;
-						*send_buffer_double_addr++ = BoneLocation.Z;
-					}
-					else if (SendData.Value == EAttribute::Quaternion)
-					{
-						const FRotator BoneRotator = OculusXRHandComponent->GetBoneRotationByName(*BoneName, EBoneSpaces::WorldSpace);
-						const FQuat BoneQuat = BoneRotator.Quaternion();
-						*send_buffer_double_addr++ = BoneQuat.W;
-						*send_buffer_double_addr++ = BoneQuat.X;
-						*send_buffer_double_addr++ = BoneQuat.Y;
-						*send_buffer_double_addr++ = BoneQuat.Z;
-					}
+				TArray<UActorComponent *> ActorComponents = PlayerPawn->GetComponentsByTag(UOculusXRHandComponent::StaticClass(), *Tag);
+				if (ActorComponents.Num() != 1)
+				{
+					UE_LOG(LogMultiverseClient, Warning, TEXT("Found %d %s"), ActorComponents.Num(), *Tag)
+					continue;
+				}
+				UOculusXRHandComponent *OculusXRHandComponent = Cast<UOculusXRHandComponent>(ActorComponents[0]);
+
+				const EOculusXRBone *Bone = OculusXRHandComponent->BoneNameMappings.FindKey(*Data.Key);
+				if (Bone == nullptr)
+				{
+					UE_LOG(LogMultiverseClient, Warning, TEXT("Bone %s is nullptr"), *Data.Key)
+					continue;
 				}
+				Binding.Type = EMultiverseBindingType::HandBone;
+				Binding.SceneComponent = OculusXRHandComponent;
+				Binding.BoneName = *UEnum::GetDisplayValueAsText(*Bone).ToString();
 			}
+		}
 #endif
+
+		if (Binding.Type == EMultiverseBindingType::None)
+		{
+			UE_LOG(LogMultiverseClient, Warning, TEXT("Failed to bind [%s] of %s"), **AttributeStringMap.FindKey(Data.Value), *Data.Key)
 		}
 	}
 }
 
-void FMultiverseClient::bind_receive_data()
+void FMultiverseClient::CompileTransformBindings(const TArray<FMultiverseBinding> &Bindings, TArray<FMultiverseTransformBinding> &TransformBindings) const
 {
-	double *receive_buffer_double_addr = receive_buffer.buffer_double.data;
-	for (const TPair<FString, EAttribute> &ReceiveData : ReceiveDataArray)
+	TransformBindings.Reset();
+
+	TMap<AActor *, int32> TransformBindingIndices;
+	for (const FMultiverseBinding &Binding : Bindings)
 	{
-		if ((*ReceiveCustomObjectsPtr).Contains(ReceiveData.Key))
+		if (Binding.Type != EMultiverseBindingType::Actor ||
+			(Binding.Attribute != EAttribute::Position && Binding.Attribute != EAttribute::Quaternion))
 		{
-			for (TPair<EAttribute, FDataContainer> &Attribute : (*ReceiveCustomObjectsPtr)[ReceiveData.Key].Attributes)
-			{
-				for (double &Data : Attribute.Value.Data)
-				{
-					Data = *receive_buffer_double_addr++;
-				}
-			}
+			continue;
 		}
-		if (CachedActors.Contains(ReceiveData.Key))
-		{
-			if (CachedActors[ReceiveData.Key] == nullptr)
-			{
-				UE_LOG(LogMultiverseClient, Warning, TEXT("Ignore None Object in CachedActors"))
-				continue;
-			}
-
-			switch (ReceiveData.Value)
-			{
-			case EAttribute::Position:
-			{
-				const double X = *receive_buffer_double_addr++;
-				const double Y = *receive_buffer_double_addr++;
-				const double Z = *receive_buffer_double_addr++;
-				CachedActors[ReceiveData.Key]->SetActorLocation(FVector(X, Y, Z));
-				break;
-			}
-
-			case EAttribute::Quaternion:
-			{
-				const double W = *receive_buffer_double_addr++;
-				const double X = *receive_buffer_double_addr++;
-				const double Y = *receive_buffer_double_addr++;
-				const double Z = *receive_buffer_double_addr++;
-				CachedActors[ReceiveData.Key]->SetActorRotation(FQuat(X, Y, Z, W));
-				break;
-			}
-
-			case EAttribute::LinearVelocity:
-			{
-				const double VelLinX = *receive_buffer_double_addr++;
-				const double VelLinY = *receive_buffer_double_addr++;
-				const double VelLinZ = *receive_buffer_double_addr++;
-				Cast<UPrimitiveComponent>(CachedActors[ReceiveData.Key]->GetRootComponent())->SetPhysicsLinearVelocity(FVector(VelLinX, VelLinY, VelLinZ));
-				break;
-			}
 
-			case EAttribute::AngularVelocity:
-			{
-				const double VelAngX = *receive_buffer_double_addr++;
-				const double VelAngY = *receive_buffer_double_addr++;
-				const double VelAngZ = *receive_buffer_double_addr++;
-				Cast<UPrimitiveComponent>(CachedActors[ReceiveData.Key]->GetRootComponent())->SetPhysicsAngularVelocityInDegrees(FVector(VelAngX, VelAngY, VelAngZ));
-				break;
-			}
+		int32 &TransformBindingIndex = TransformBindingIndices.FindOrAdd(Binding.Actor, INDEX_NONE);
+		if (TransformBindingIndex == INDEX_NONE)
+		{
+			TransformBindingIndex = TransformBindings.Num();
+			TransformBindings.AddDefaulted_GetRef().Actor = Binding.Actor;
+		}
 
-			case EAttribute::Force:
-			{
-				const double ForceX = *receive_buffer_double_addr++;
-				const double ForceY = *receive_buffer_double_addr++;
-				const double ForceZ = *receive_buffer_double_addr++;
-				Cast<UPrimitiveComponent>(CachedActors[ReceiveData.Key]->GetRootComponent())->AddForce(FVector(ForceX, ForceY, ForceZ));
-				break;
-			}
+		if (Binding.Attribute == EAttribute::Position)
+		{
+			TransformBindings[TransformBindingIndex].PositionOffset = Binding.DoubleOffset;
+		}
+		else
+		{
+			TransformBindings[TransformBindingIndex].QuaternionOffset = Binding.DoubleOffset;
+		}
+	}
+}
 
-			case EAttribute::Torque:
-			{
-				const double TorqueX = *receive_buffer_double_addr++;
-				const double TorqueY = *receive_buffer_double_addr++;
-				const double TorqueZ = *receive_buffer_double_addr++;
-				Cast<UPrimitiveComponent>(CachedActors[ReceiveData.Key]->GetRootComponent())->AddTorqueInRadians(FVector(TorqueX, TorqueY, TorqueZ));
-				break;
-			}
+void FMultiverseClient::CompileAnimBindings(const TArray<FMultiverseBinding> &Bindings, TArray<FMultiverseAnimBinding> &AnimBindings) const
+{
+	AnimBindings.Reset();
 
-			default:
-				break;
-			}
+	TMap<UMultiverseAnim *, int32> AnimBindingIndices;
+	for (const FMultiverseBinding &Binding : Bindings)
+	{
+		if (Binding.Type != EMultiverseBindingType::Bone)
+		{
+			continue;
 		}
-		else if (CachedBoneNames.Contains(ReceiveData.Key))
+
+		for (const FMultiverseAnimJoint &Joint : Binding.Joints)
 		{
-			const double JointValue = *receive_buffer_double_addr++;
-			for (TPair<UMultiverseAnim *, FName> &BoneNameMapping : CachedBoneNames[ReceiveData.Key])
+			int32 &AnimBindingIndex = AnimBindingIndices.FindOrAdd(Joint.Anim, INDEX_NONE);
+			if (AnimBindingIndex == INDEX_NONE)
 			{
-				switch (ReceiveData.Value)
-				{
-				case EAttribute::JointAngularPosition:
-				{
-					BoneNameMapping.Key->JointPoses[BoneNameMapping.Value].SetRotation(FQuat(FRotator(JointValue, 0.f, 0.f)));
-					break;
-				}
-
-				case EAttribute::JointLinearPosition:
-				{
-					BoneNameMapping.Key->JointPoses[BoneNameMapping.Value].SetTranslation(FVector(0.f, JointValue, 0.f));
-					break;
-				}
-
-				default:
-					break;
-				}
+				AnimBindingIndex = AnimBindings.Num();
+				FMultiverseAnimBinding &AnimBinding = AnimBindings.AddDefaulted_GetRef();
+				AnimBinding.Anim = Joint.Anim;
+				AnimBinding.Actor = Joint.Actor;
 			}
+
+			AnimBindings[AnimBindingIndex].Joints.Add({Joint.JointIndex, Binding.Attribute, Binding.DoubleOffset});
 		}
 	}
 }
 
 void FMultiverseClient::clean_up()
 {
+	if (DeferToGameThread([this]()
+						  { clean_up(); }))
+	{
+		return;
+	}
+
+	bSendAndReceiveDataBound = false;
+
 	SendDataArray.Empty();
 
 	ReceiveDataArray.Empty();
+
+	SendBindings.Empty();
+
+	ReceiveBindings.Empty();
+
+	ReceiveTransformBindings.Empty();
+
+	ReceiveAnimBindings.Empty();
+
+	SendPhysicsBindings.Empty();
+
+	ReceivePhysicsBindings.Empty();
+
+	PublishPhysicsBindings();
+
+	ReceiveInterpolationSlots.Empty();
+
+	ReceiveJitterBuffer.Reset(Settings.JitterBufferSize);
+
+	CaptureScheduler.Reset(Settings.MaxCapturesPerFrame);
+
+	ReleaseRenderTargets();
+}
+
+void FMultiverseClient::ReleaseRenderTargets()
+{
+	for (const TPair<TWeakObjectPtr<USceneCaptureComponent2D>, FName> &BoundSceneCaptureComponent : BoundSceneCaptureComponents)
+	{
+		USceneCaptureComponent2D *SceneCaptureComponent = BoundSceneCaptureComponent.Key.Get();
+		if (SceneCaptureComponent == nullptr)
+		{
+			continue;
+		}
+
+		SceneCaptureComponent->ComponentTags.Remove(BoundSceneCaptureComponent.Value);
+		if (SceneCaptureComponent->TextureTarget != nullptr)
+		{
+			SceneCaptureComponent->TextureTarget->ReleaseResource();
+			SceneCaptureComponent->TextureTarget = nullptr;
+		}
+	}
+	if (BoundSceneCaptureComponents.Num() > 0)
+	{
+		// Binding the layout again creates the render targets
+		SendLayoutJson.Reset();
+		ReceiveLayoutJson.Reset();
+	}
+	BoundSceneCaptureComponents.Empty();
 }
 
 void FMultiverseClient::reset()
 {
 	StartTime = FPlatformTime::Seconds();
-}
\ No newline at end of file
+
+	// The offsets were measured against the previous start time
+	ClockEstimator.Reset();
+}
+
+/** Time of the response meta data parse as JSON objects and as the single pass into flat arrays */
+static void BenchmarkResponseMetaData(const TArray<FString> &Args)
+{
+	const int32 ObjectNum = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 1000;
+	const int32 Iterations = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 10;
+
+	FString ResponseMetaDataString = TEXT("{\"meta_data\":{\"world_name\":\"world\",\"simulation_name\":\"unreal\"},\"time\":1.0,\"send\":{");
+	for (int32 ObjectIndex = 0; ObjectIndex < ObjectNum; ObjectIndex++)
+	{
+		ResponseMetaDataString += FString::Printf(TEXT("%s\"object_%d\":{\"position\":[%d.5,-1.25,0.125],\"quaternion\":[1.0,0.0,0.0,0.0],\"joint_angular_position\":[0.5]}"),
+												  ObjectIndex > 0 ? TEXT(",") : TEXT(""), ObjectIndex, ObjectIndex);
+	}
+	ResponseMetaDataString += TEXT("},\"receive\":{}}");
+
+	double DomSeconds = 0.0;
+	double StreamSeconds = 0.0;
+	FMultiverseResponseData SendData;
+	FMultiverseResponseData ReceiveData;
+	for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+	{
+		double StartTime = FPlatformTime::Seconds();
+		TSharedPtr<FJsonObject> DomJson = MakeShareable(new FJsonObject);
+		FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(ResponseMetaDataString), DomJson);
+		DomSeconds += FPlatformTime::Seconds() - StartTime;
+
+		StartTime = FPlatformTime::Seconds();
+		TSharedPtr<FJsonObject> ResponseMetaDataJson = MakeShareable(new FJsonObject);
+		SendData.Reset();
+		ReceiveData.Reset();
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ResponseMetaDataString);
+		ReadResponseMetaData(*Reader, ResponseMetaDataJson, SendData, ReceiveData);
+		StreamSeconds += FPlatformTime::Seconds() - StartTime;
+	}
+
+	UE_LOG(LogMultiverseClient, Display, TEXT("%d objects, %d bytes: json objects %.3f ms, single pass %.3f ms, %d attributes read"),
+		   ObjectNum, ResponseMetaDataString.Len(), DomSeconds * 1000.0 / Iterations, StreamSeconds * 1000.0 / Iterations, SendData.Attributes.Num())
+}
+
+static FAutoConsoleCommand BenchmarkResponseMetaDataCommand(
+	TEXT("Multiverse.BenchmarkResponseMetaData"),
+	TEXT("Log the parse time of a synthetic response meta data. Optional arguments: objects (default 1000), iterations (default 10)"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkResponseMetaData));
@@ -4,9 +4,46 @@
 
 #include "MultiverseClientComponent.h"
 #include "Kismet/GameplayStatics.h"
+#include "LatentActions.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogMultiverseClientActor, Log, All);
 
+class FMultiverseCallApisAction final : public FPendingLatentAction
+{
+public:
+	FMultiverseCallApisAction(TFuture<TMap<FString, FApiCallbacks>> &&InFuture,
+							  TMap<FString, FApiCallbacks> &InSimulationApiCallbacksResponse,
+							  const FLatentActionInfo &LatentInfo)
+		: Future(MoveTemp(InFuture)),
+		  SimulationApiCallbacksResponse(InSimulationApiCallbacksResponse),
+		  ExecutionFunction(LatentInfo.ExecutionFunction),
+		  OutputLink(LatentInfo.Linkage),
+		  CallbackTarget(LatentInfo.CallbackTarget)
+	{
+	}
+
+	virtual void UpdateOperation(FLatentResponse &Response) override
+	{
+		const bool bIsReady = Future.IsReady();
+		if (bIsReady)
+		{
+			SimulationApiCallbacksResponse = Future.Consume();
+		}
+		Response.FinishAndTriggerIf(bIsReady, ExecutionFunction, OutputLink, CallbackTarget);
+	}
+
+private:
+	TFuture<TMap<FString, FApiCallbacks>> Future;
+
+	TMap<FString, FApiCallbacks> &SimulationApiCallbacksResponse;
+
+	FName ExecutionFunction;
+
+	int32 OutputLink;
+
+	FWeakObjectPtr CallbackTarget;
+};
+
 // Sets default values
 AMultiverseClientActor::AMultiverseClientActor()
 {
@@ -21,6 +58,11 @@ void AMultiverseClientActor::BeginPlay()
 {
 	Super::BeginPlay();
 
+	SetTickGroup(MultiverseClientComponent->TickGroup);
+
+	// Lockstep pauses the game while the server does not step, the client keeps exchanging to resume it
+	SetTickableWhenPaused(MultiverseClientComponent->bLockstep);
+
 	Init();
 }
 
@@ -88,3 +130,21 @@ void AMultiverseClientActor::Init() const
 
 	MultiverseClientComponent->Init();
 }
+
+void AMultiverseClientActor::CallApis(const TMap<FString, FApiCallbacks> &SimulationApiCallbacks, float Timeout,
+									  TMap<FString, FApiCallbacks> &SimulationApiCallbacksResponse, FLatentActionInfo LatentInfo)
+{
+	UWorld *World = GetWorld();
+	if (!World)
+	{
+		UE_LOG(LogMultiverseClientActor, Error, TEXT("World not found"));
+		return;
+	}
+
+	FLatentActionManager &LatentActionManager = World->GetLatentActionManager();
+	if (LatentActionManager.FindExistingAction<FMultiverseCallApisAction>(LatentInfo.CallbackTarget, LatentInfo.UUID) == nullptr)
+	{
+		LatentActionManager.AddNewAction(LatentInfo.CallbackTarget, LatentInfo.UUID,
+										 new FMultiverseCallApisAction(MultiverseClientComponent->CallApis(SimulationApiCallbacks, Timeout), SimulationApiCallbacksResponse, LatentInfo));
+	}
+}
\ No newline at end of file
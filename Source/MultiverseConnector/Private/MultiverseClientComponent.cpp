@@ -65,31 +65,96 @@ void UMultiverseClientComponent::Init()
         }
     }
     UE_LOG(LogMultiverseClientComponent, Log, TEXT("ClientPort: %s"), *ClientPort)
-    MultiverseClient.Init(ServerHost, ServerPort, ClientPort, WorldName, SimulationName, SendObjects, ReceiveObjects, &SendCustomObjects, &ReceiveCustomObjects, GetWorld());
+
+    UpdateScheduler.Reset(CatchUpPolicy, MaxCatchUpSteps);
+    ImageUpdateScheduler.Reset(EMultiverseCatchUpPolicy::Merge);
+
+    FMultiverseClientSettings Settings;
+    Settings.bAsyncCommunication = bAsyncCommunication && !bLockstep;
+    Settings.ParallelGatherThreshold = ParallelGatherThreshold;
+    Settings.bPhysicsStepCommunication = bPhysicsStepCommunication && !bLockstep;
+    Settings.bLockstep = bLockstep;
+    Settings.LockstepTimeout = LockstepTimeout;
+    Settings.ReceiveTeleportType = ReceiveTeleportType;
+    Settings.bInterpolateReceiveData = bInterpolateReceiveData;
+    Settings.InterpolationDelay = InterpolationDelay;
+    Settings.MaxExtrapolationTime = MaxExtrapolationTime;
+    Settings.JitterBufferSize = JitterBufferSize;
+    Settings.bAsyncCameraReadback = bAsyncCameraReadback;
+    Settings.CameraReadbackRingSize = CameraReadbackRingSize;
+    Settings.DepthConversion.Scale = DepthScale;
+    Settings.DepthConversion.MinDepth = MinDepth;
+    Settings.DepthConversion.MaxDepth = MaxDepth;
+    Settings.MaxCapturesPerFrame = MaxCapturesPerFrame;
+    Settings.ImageEncoding = ImageEncoding;
+    Settings.ImageEncodingQuality = ImageEncodingQuality;
+    Settings.ImageCompressionRatio = ImageCompressionRatio;
+    if (!bSeparateImageChannel)
+    {
+        MultiverseClient.Init(ServerHost, ServerPort, ClientPort, WorldName, SimulationName, SendObjects, ReceiveObjects, &SendCustomObjects, &ReceiveCustomObjects, GetWorld(), Settings);
+        return;
+    }
+
+    TMap<AActor *, FAttributeContainer> PoseSendObjects;
+    TMap<AActor *, FAttributeContainer> ImageSendObjects;
+    FMultiverseClient::SplitSensorObjects(SendObjects, PoseSendObjects, ImageSendObjects);
+    MultiverseClient.Init(ServerHost, ServerPort, ClientPort, WorldName, SimulationName, PoseSendObjects, ReceiveObjects, &SendCustomObjects, &ReceiveCustomObjects, GetWorld(), Settings);
+    if (ImageSendObjects.Num() == 0)
+    {
+        return;
+    }
+
+    const FString ImagePort = ImageClientPort.IsEmpty() ? FString::FromInt(FCString::Atoi(*ClientPort) + 1) : ImageClientPort;
+    UE_LOG(LogMultiverseClientComponent, Log, TEXT("ImageClientPort: %s"), *ImagePort)
+
+    // The image round-trip always runs on its own thread, the pose client never waits for it
+    FMultiverseClientSettings ImageSettings = Settings;
+    ImageSettings.bAsyncCommunication = true;
+    ImageSettings.bInterpolateReceiveData = false;
+    ImageSettings.bPhysicsStepCommunication = false;
+    ImageSettings.bLockstep = false;
+    TMap<AActor *, FAttributeContainer> ImageReceiveObjects;
+    ImageClient = MakeUnique<FMultiverseClient>();
+    ImageClient->Init(ServerHost, ServerPort, ImagePort, WorldName, SimulationName + TEXT("_images"), ImageSendObjects, ImageReceiveObjects, &ImageCustomObjects, &ImageCustomObjects, GetWorld(), ImageSettings);
 }
 
 void UMultiverseClientComponent::Tick(float DeltaTime)
 {
-    CurrentCycleTime += DeltaTime;
+    MultiverseClient.ProcessApiCalls();
+    if (SimulationApiCallbacksFuture.IsValid() && SimulationApiCallbacksFuture.IsReady())
+    {
+        SimulationApiCallbacksResponse = SimulationApiCallbacksFuture.Consume();
+    }
+    MultiverseClient.UpdateInterpolation();
+
+    // Images are never caught up, only the newest frame is worth sending
+    ImageUpdateScheduler.SetRate(ImageUpdateRate);
+    if (ImageUpdateScheduler.Advance(DeltaTime) > 0 && ImageClient.IsValid())
+    {
+        ImageClient->Communicate();
+    }
+
+    UpdateScheduler.SetRate(UpdateRate);
+    const int32 UpdateSteps = bLockstep ? 1 : UpdateScheduler.Advance(DeltaTime);
+    MeasuredUpdateRate = UpdateScheduler.GetMeasuredRate();
+    ClockStatistics = MultiverseClient.GetClockStatistics();
     CurrentSimulationApiCycleTime += DeltaTime;
-    if (UpdateRate <= 0.f && SimulationApiCallbacksRate <= 0.f)
+    if (!bLockstep && UpdateRate <= 0.f && SimulationApiCallbacksRate <= 0.f)
     {
         return;
     }
-    if (SimulationApiCallbacks.Num() > 0 && bSimulationApiCallbacksEnabled && CurrentSimulationApiCycleTime >= 1.f / SimulationApiCallbacksRate)
+    if (SimulationApiCallbacks.Num() > 0 && bSimulationApiCallbacksEnabled && !SimulationApiCallbacksFuture.IsValid() && CurrentSimulationApiCycleTime >= 1.f / SimulationApiCallbacksRate)
     {
-        SimulationApiCallbacksResponse = MultiverseClient.CallApis(SimulationApiCallbacks);
+        SimulationApiCallbacksFuture = MultiverseClient.CallApis(SimulationApiCallbacks, SimulationApiCallbacksTimeout);
     }
     
-    if (CurrentCycleTime >= 1.f / UpdateRate || (bSimulationApiCallbacksEnabled && CurrentSimulationApiCycleTime >= 1.f / SimulationApiCallbacksRate))
+    // A due API call needs an exchange even between the update steps
+    const bool bSimulationApiCallDue = bSimulationApiCallbacksEnabled && CurrentSimulationApiCycleTime >= 1.f / SimulationApiCallbacksRate;
+    for (int32 Step = 0; Step < FMath::Max(UpdateSteps, bSimulationApiCallDue ? 1 : 0); Step++)
     {
-        MultiverseClient.communicate();
+        MultiverseClient.Communicate();
     }
 
-    if (CurrentCycleTime >= 1.f / UpdateRate)
-    {
-        CurrentCycleTime = 0.f;
-    }
     if (CurrentSimulationApiCycleTime >= 1.f / SimulationApiCallbacksRate)
     {
         CurrentSimulationApiCycleTime = 0.f;
@@ -98,5 +163,66 @@ void UMultiverseClientComponent::Tick(float DeltaTime)
 
 void UMultiverseClientComponent::Deinit()
 {
-    MultiverseClient.disconnect();
-}
\ No newline at end of file
+    MultiverseClient.Deinit();
+    if (ImageClient.IsValid())
+    {
+        ImageClient->Deinit();
+        ImageClient.Reset();
+    }
+}
+
+TFuture<TMap<FString, FApiCallbacks>> UMultiverseClientComponent::CallApis(const TMap<FString, FApiCallbacks> &InSimulationApiCallbacks, float Timeout)
+{
+    return MultiverseClient.CallApis(InSimulationApiCallbacks, Timeout);
+}
+
+void UMultiverseClientComponent::AddSendObject(AActor *Actor, const FAttributeContainer &Attributes)
+{
+    SendObjects.Add(Actor, Attributes);
+    if (!ImageClient.IsValid())
+    {
+        MultiverseClient.AddSendObject(Actor, Attributes);
+        return;
+    }
+
+    TMap<AActor *, FAttributeContainer> AddedSendObjects;
+    AddedSendObjects.Add(Actor, Attributes);
+    TMap<AActor *, FAttributeContainer> PoseSendObjects;
+    TMap<AActor *, FAttributeContainer> ImageSendObjects;
+    FMultiverseClient::SplitSensorObjects(AddedSendObjects, PoseSendObjects, ImageSendObjects);
+    if (const FAttributeContainer *PoseAttributes = PoseSendObjects.Find(Actor))
+    {
+        MultiverseClient.AddSendObject(Actor, *PoseAttributes);
+    }
+    if (const FAttributeContainer *ImageAttributes = ImageSendObjects.Find(Actor))
+    {
+        ImageClient->AddSendObject(Actor, *ImageAttributes);
+    }
+}
+
+void UMultiverseClientComponent::AddReceiveObject(AActor *Actor, const FAttributeContainer &Attributes)
+{
+    ReceiveObjects.Add(Actor, Attributes);
+    MultiverseClient.AddReceiveObject(Actor, Attributes);
+}
+
+void UMultiverseClientComponent::RemoveObject(AActor *Actor)
+{
+    SendObjects.Remove(Actor);
+    ReceiveObjects.Remove(Actor);
+    MultiverseClient.RemoveObject(Actor);
+    if (ImageClient.IsValid())
+    {
+        ImageClient->RemoveObject(Actor);
+    }
+}
+
+void UMultiverseClientComponent::SetReceiveTeleport(bool bTeleport)
+{
+    ReceiveTeleportType = TeleportFlagToEnum(bTeleport);
+}
+
+bool UMultiverseClientComponent::GetReceiveTeleport() const
+{
+    return ReceiveTeleportType != ETeleportType::None;
+}
@@ -0,0 +1,93 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#include "MultiverseClockEstimator.h"
+
+#include "Misc/ScopeLock.h"
+
+void FMultiverseClockEstimator::Reset(int32 InWindowSize)
+{
+	FScopeLock Lock(&CriticalSection);
+	WindowSize = FMath::Max(InWindowSize, 1);
+	Samples.Reset(WindowSize);
+	NextSample = 0;
+	ClockOffset = 0.0;
+	Jitter = 0.0;
+	LastRoundTripTime = -1.0;
+}
+
+void FMultiverseClockEstimator::AddSample(double SendTime, double ServerTime, double ReceiveTime)
+{
+	const double RoundTripTime = ReceiveTime - SendTime;
+	if (RoundTripTime < 0.0)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&CriticalSection);
+	const FSample Sample{RoundTripTime, ServerTime - (SendTime + ReceiveTime) * 0.5};
+	if (Samples.Num() < WindowSize)
+	{
+		Samples.Add(Sample);
+	}
+	else
+	{
+		Samples[NextSample] = Sample;
+	}
+	NextSample = (NextSample + 1) % WindowSize;
+
+	const FSample *BestSample = &Samples[0];
+	for (const FSample &WindowSample : Samples)
+	{
+		if (WindowSample.RoundTripTime < BestSample->RoundTripTime)
+		{
+			BestSample = &WindowSample;
+		}
+	}
+	ClockOffset = BestSample->ClockOffset;
+
+	// Interarrival jitter as in RFC 3550
+	if (LastRoundTripTime >= 0.0)
+	{
+		Jitter += (FMath::Abs(RoundTripTime - LastRoundTripTime) - Jitter) / 16.0;
+	}
+	LastRoundTripTime = RoundTripTime;
+}
+
+double FMultiverseClockEstimator::ToServerTime(double LocalTime) const
+{
+	FScopeLock Lock(&CriticalSection);
+	return LocalTime + ClockOffset;
+}
+
+FMultiverseClockStatistics FMultiverseClockEstimator::GetStatistics() const
+{
+	TArray<double> RoundTripTimes;
+	FMultiverseClockStatistics Statistics;
+	{
+		FScopeLock Lock(&CriticalSection);
+		RoundTripTimes.Reserve(Samples.Num());
+		for (const FSample &Sample : Samples)
+		{
+			RoundTripTimes.Add(Sample.RoundTripTime);
+		}
+		Statistics.ClockOffset = ClockOffset;
+		Statistics.Jitter = Jitter;
+	}
+
+	Statistics.SampleNum = RoundTripTimes.Num();
+	if (RoundTripTimes.Num() == 0)
+	{
+		return Statistics;
+	}
+
+	RoundTripTimes.Sort();
+	double RoundTripTimeSum = 0.0;
+	for (const double RoundTripTime : RoundTripTimes)
+	{
+		RoundTripTimeSum += RoundTripTime;
+	}
+	Statistics.RoundTripTimeMean = RoundTripTimeSum / RoundTripTimes.Num();
+	Statistics.RoundTripTimeP50 = RoundTripTimes[(RoundTripTimes.Num() - 1) / 2];
+	Statistics.RoundTripTimeP99 = RoundTripTimes[FMath::Min(FMath::CeilToInt32(RoundTripTimes.Num() * 0.99) - 1, RoundTripTimes.Num() - 1)];
+	return Statistics;
+}
@@ -0,0 +1,165 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#include "MultiverseCommunicationThread.h"
+
+#include "HAL/Event.h"
+#include "HAL/RunnableThread.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/ScopeLock.h"
+
+FMultiverseGameThreadCalls::FCall::FCall()
+{
+	DoneEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FMultiverseGameThreadCalls::FCall::~FCall()
+{
+	FPlatformProcess::ReturnSynchEventToPool(DoneEvent);
+	DoneEvent = nullptr;
+}
+
+void FMultiverseGameThreadCalls::FCall::Run()
+{
+	TFunction<void()> CallFunction;
+	{
+		FScopeLock Lock(&CriticalSection);
+		CallFunction = MoveTemp(Function);
+		Function.Reset();
+	}
+
+	if (CallFunction)
+	{
+		CallFunction();
+		DoneEvent->Trigger();
+	}
+}
+
+FMultiverseGameThreadCalls::FMultiverseGameThreadCalls()
+{
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+}
+
+FMultiverseGameThreadCalls::~FMultiverseGameThreadCalls()
+{
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+void FMultiverseGameThreadCalls::Call(TFunctionRef<void()> Function)
+{
+	check(!IsInGameThread());
+
+	// Whoever runs the call first empties it, the task may outlive this scope and must not touch Function then
+	TSharedRef<FCall, ESPMode::ThreadSafe> Call = MakeShared<FCall, ESPMode::ThreadSafe>();
+	Call->Function = [&Function]()
+	{ Function(); };
+	{
+		FScopeLock Lock(&CriticalSection);
+		PendingCall = Call;
+	}
+	WakeEvent->Trigger();
+
+	FFunctionGraphTask::CreateAndDispatchWhenReady([Call]()
+												   { Call->Run(); },
+												   TStatId(), nullptr, ENamedThreads::GameThread);
+	Call->DoneEvent->Wait();
+
+	FScopeLock Lock(&CriticalSection);
+	if (PendingCall == Call)
+	{
+		PendingCall.Reset();
+	}
+}
+
+void FMultiverseGameThreadCalls::Notify()
+{
+	WakeEvent->Trigger();
+}
+
+void FMultiverseGameThreadCalls::WaitUntil(TFunctionRef<bool()> Predicate)
+{
+	while (!Predicate())
+	{
+		TSharedPtr<FCall, ESPMode::ThreadSafe> Call;
+		if (IsInGameThread())
+		{
+			FScopeLock Lock(&CriticalSection);
+			Call = MoveTemp(PendingCall);
+			PendingCall.Reset();
+		}
+		if (Call.IsValid())
+		{
+			Call->Run();
+			continue;
+		}
+
+		WakeEvent->Wait();
+	}
+}
+
+FMultiverseCommunicationThread::FMultiverseCommunicationThread(TFunction<void()> InCommunicate, const FString &ThreadName, FMultiverseGameThreadCalls &InGameThreadCalls)
+	: Communicate(MoveTemp(InCommunicate)), GameThreadCalls(InGameThreadCalls)
+{
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	bRunning = true;
+	Thread = FRunnableThread::Create(this, *ThreadName, 0, TPri_AboveNormal);
+}
+
+FMultiverseCommunicationThread::~FMultiverseCommunicationThread()
+{
+	Shutdown();
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	WakeEvent = nullptr;
+}
+
+void FMultiverseCommunicationThread::Wake()
+{
+	WakeEvent->Trigger();
+}
+
+void FMultiverseCommunicationThread::Shutdown()
+{
+	if (Thread == nullptr)
+	{
+		return;
+	}
+
+	Stop();
+
+	// The round-trip in flight may be waiting for the game thread (e.g. a re-handshake), keep serving it
+	GameThreadCalls.WaitUntil([this]()
+							  { return !bRunning; });
+
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+}
+
+bool FMultiverseCommunicationThread::IsCommunicationThread() const
+{
+	return Thread != nullptr && Thread->GetThreadID() == FPlatformTLS::GetCurrentThreadId();
+}
+
+uint32 FMultiverseCommunicationThread::Run()
+{
+	while (!bStopRequested)
+	{
+		WakeEvent->Wait();
+		if (bStopRequested)
+		{
+			break;
+		}
+
+		Communicate();
+	}
+
+	bRunning = false;
+	GameThreadCalls.Notify();
+	return 0;
+}
+
+void FMultiverseCommunicationThread::Stop()
+{
+	bStopRequested = true;
+	WakeEvent->Trigger();
+}
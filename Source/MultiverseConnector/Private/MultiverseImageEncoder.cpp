@@ -0,0 +1,207 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#include "MultiverseImageEncoder.h"
+
+#include "HAL/IConsoleManager.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "Math/RandomStream.h"
+#include "Misc/Compression.h"
+#include "Modules/ModuleManager.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogMultiverseImageEncoder, Log, All);
+
+static const FName ImageWrapperModuleName = TEXT("ImageWrapper");
+
+const TCHAR *MultiverseImageEncoder::GetEncodingName(EMultiverseImageEncoding Encoding)
+{
+	switch (Encoding)
+	{
+	case EMultiverseImageEncoding::Raw:
+		return TEXT("raw");
+
+	case EMultiverseImageEncoding::LZ4:
+		return TEXT("lz4");
+
+	case EMultiverseImageEncoding::Zlib:
+		return TEXT("zlib");
+
+	case EMultiverseImageEncoding::JPEG:
+		return TEXT("jpeg");
+
+	default:
+		return TEXT("none");
+	}
+}
+
+EMultiverseImageEncoding MultiverseImageEncoder::GetEffectiveEncoding(EMultiverseImageEncoding Encoding, int32 BytesPerPixel)
+{
+	return Encoding == EMultiverseImageEncoding::JPEG && BytesPerPixel != 3 ? EMultiverseImageEncoding::LZ4 : Encoding;
+}
+
+int32 MultiverseImageEncoder::GetMaxEncodedSize(EMultiverseImageEncoding Encoding, int32 Size, int32 BytesPerPixel)
+{
+	switch (GetEffectiveEncoding(Encoding, BytesPerPixel))
+	{
+	case EMultiverseImageEncoding::LZ4:
+		return FCompression::CompressMemoryBound(NAME_LZ4, Size);
+
+	case EMultiverseImageEncoding::Zlib:
+		return FCompression::CompressMemoryBound(NAME_Zlib, Size);
+
+	case EMultiverseImageEncoding::JPEG:
+		// Noise at quality 100 can exceed the raw size, the headers and tables come on top
+		return Size + Size / 4 + 2048;
+
+	default:
+		return Size;
+	}
+}
+
+bool MultiverseImageEncoder::Initialize(EMultiverseImageEncoding Encoding)
+{
+	check(IsInGameThread());
+
+	if (Encoding == EMultiverseImageEncoding::JPEG && FModuleManager::Get().LoadModule(ImageWrapperModuleName) == nullptr)
+	{
+		UE_LOG(LogMultiverseImageEncoder, Error, TEXT("Module %s is not available, cannot encode JPEG images"), *ImageWrapperModuleName.ToString())
+		return false;
+	}
+	return true;
+}
+
+bool MultiverseImageEncoder::Encode(EMultiverseImageEncoding Encoding, const uint8 *Data, int32 Width, int32 Height, int32 BytesPerPixel, int32 Quality, TArray<uint8> &OutData)
+{
+	const int32 Size = Width * Height * BytesPerPixel;
+	switch (GetEffectiveEncoding(Encoding, BytesPerPixel))
+	{
+	case EMultiverseImageEncoding::None:
+	case EMultiverseImageEncoding::Raw:
+		OutData.SetNumUninitialized(Size);
+		FMemory::Memcpy(OutData.GetData(), Data, Size);
+		return true;
+
+	case EMultiverseImageEncoding::LZ4:
+	case EMultiverseImageEncoding::Zlib:
+	{
+		const FName FormatName = Encoding == EMultiverseImageEncoding::Zlib ? NAME_Zlib : NAME_LZ4;
+		int32 CompressedSize = FCompression::CompressMemoryBound(FormatName, Size);
+		OutData.SetNumUninitialized(CompressedSize);
+		if (!FCompression::CompressMemory(FormatName, OutData.GetData(), CompressedSize, Data, Size))
+		{
+			OutData.Reset();
+			return false;
+		}
+		OutData.SetNum(CompressedSize, false);
+		return true;
+	}
+
+	case EMultiverseImageEncoding::JPEG:
+	{
+		IImageWrapperModule *ImageWrapperModule = FModuleManager::GetModulePtr<IImageWrapperModule>(ImageWrapperModuleName);
+		TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule != nullptr ? ImageWrapperModule->CreateImageWrapper(EImageFormat::JPEG) : nullptr;
+		if (!ImageWrapper.IsValid())
+		{
+			OutData.Reset();
+			return false;
+		}
+
+		// The JPEG encoder takes 4 channels
+		TArray<uint8> RGBA;
+		RGBA.SetNumUninitialized(Width * Height * 4);
+		for (int32 PixelIndex = 0; PixelIndex < Width * Height; PixelIndex++)
+		{
+			RGBA[PixelIndex * 4] = Data[PixelIndex * 3];
+			RGBA[PixelIndex * 4 + 1] = Data[PixelIndex * 3 + 1];
+			RGBA[PixelIndex * 4 + 2] = Data[PixelIndex * 3 + 2];
+			RGBA[PixelIndex * 4 + 3] = 255;
+		}
+		if (!ImageWrapper->SetRaw(RGBA.GetData(), RGBA.Num(), Width, Height, ERGBFormat::RGBA, 8))
+		{
+			OutData.Reset();
+			return false;
+		}
+		const TArray64<uint8> &Compressed = ImageWrapper->GetCompressed(Quality);
+		OutData.SetNumUninitialized(Compressed.Num());
+		FMemory::Memcpy(OutData.GetData(), Compressed.GetData(), Compressed.Num());
+		return true;
+	}
+
+	default:
+		return false;
+	}
+}
+
+bool MultiverseImageEncoder::WriteToSlot(const TArray<uint8> &EncodedData, double CaptureTime, uint8 *Slot, int32 SlotSize)
+{
+	if (HeaderSize + EncodedData.Num() > SlotSize)
+	{
+		// A size of 0 tells the receiver to keep its previous image
+		FMemory::Memzero(Slot, HeaderSize);
+		return false;
+	}
+
+	const uint32 EncodedSize = EncodedData.Num();
+	Slot[0] = EncodedSize & 0xFF;
+	Slot[1] = (EncodedSize >> 8) & 0xFF;
+	Slot[2] = (EncodedSize >> 16) & 0xFF;
+	Slot[3] = (EncodedSize >> 24) & 0xFF;
+	uint64 CaptureTimeBits;
+	FMemory::Memcpy(&CaptureTimeBits, &CaptureTime, sizeof(double));
+	for (int32 ByteIndex = 0; ByteIndex < sizeof(double); ByteIndex++)
+	{
+		Slot[sizeof(uint32) + ByteIndex] = (CaptureTimeBits >> (ByteIndex * 8)) & 0xFF;
+	}
+	FMemory::Memcpy(Slot + HeaderSize, EncodedData.GetData(), EncodedData.Num());
+	return true;
+}
+
+/** Throughput of every encoding on synthetic camera images at the resolutions of the camera attributes, CPU only */
+static void BenchmarkImageEncoding(const TArray<FString> &Args)
+{
+	const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 10;
+	const FIntPoint Resolutions[] = {{128, 128}, {640, 480}, {1280, 1024}, {3840, 2160}};
+	const EMultiverseImageEncoding Encodings[] = {EMultiverseImageEncoding::None, EMultiverseImageEncoding::LZ4, EMultiverseImageEncoding::Zlib, EMultiverseImageEncoding::JPEG};
+	MultiverseImageEncoder::Initialize(EMultiverseImageEncoding::JPEG);
+
+	FRandomStream RandomStream(0);
+	TArray<uint8> EncodedData;
+	for (const FIntPoint &Resolution : Resolutions)
+	{
+		for (const int32 BytesPerPixel : {3, 2})
+		{
+			// Smooth gradients with sensor noise, close enough to rendered images for relative numbers
+			TArray<uint8> Image;
+			Image.SetNumUninitialized(Resolution.X * Resolution.Y * BytesPerPixel);
+			for (int32 Index = 0; Index < Image.Num(); Index++)
+			{
+				const int32 PixelIndex = Index / BytesPerPixel;
+				Image[Index] = static_cast<uint8>((PixelIndex % Resolution.X + PixelIndex / Resolution.X + (Index % BytesPerPixel) * 64) / 8 + RandomStream.RandHelper(4));
+			}
+
+			for (const EMultiverseImageEncoding Encoding : Encodings)
+			{
+				if (MultiverseImageEncoder::GetEffectiveEncoding(Encoding, BytesPerPixel) != Encoding)
+				{
+					continue;
+				}
+
+				const double StartTime = FPlatformTime::Seconds();
+				for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+				{
+					MultiverseImageEncoder::Encode(Encoding, Image.GetData(), Resolution.X, Resolution.Y, BytesPerPixel, 85, EncodedData);
+				}
+				const double Seconds = (FPlatformTime::Seconds() - StartTime) / Iterations;
+
+				UE_LOG(LogMultiverseImageEncoder, Display, TEXT("%s_%d_%d %-4s: %8.3f ms, %8.1f MB/s, ratio %5.2f"),
+					   BytesPerPixel == 3 ? TEXT("rgb") : TEXT("depth"), Resolution.X, Resolution.Y, MultiverseImageEncoder::GetEncodingName(Encoding),
+					   Seconds * 1000.0, Image.Num() / Seconds / (1024.0 * 1024.0), EncodedData.Num() > 0 ? static_cast<double>(Image.Num()) / EncodedData.Num() : 0.0)
+			}
+		}
+	}
+}
+
+static FAutoConsoleCommand BenchmarkImageEncodingCommand(
+	TEXT("Multiverse.BenchmarkImageEncoding"),
+	TEXT("Log the throughput of every image encoding at every camera resolution. Optional argument: iterations (default 10)"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkImageEncoding));
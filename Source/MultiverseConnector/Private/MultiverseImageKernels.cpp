@@ -0,0 +1,388 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#include "MultiverseImageKernels.h"
+
+#include "HAL/IConsoleManager.h"
+
+#if PLATFORM_ENABLE_VECTORINTRINSICS_NEON
+#include <arm_neon.h>
+#define MULTIVERSE_IMAGE_KERNELS_NEON 1
+#elif PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY
+// x64 targets only assume SSE2 by default, the SSSE3 loop is compiled for SSSE3 on its own and picked at runtime
+#include <tmmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#if defined(__clang__) || defined(__GNUC__)
+#define MULTIVERSE_SSSE3_TARGET __attribute__((target("ssse3")))
+#else
+#define MULTIVERSE_SSSE3_TARGET
+#endif
+#define MULTIVERSE_IMAGE_KERNELS_SSSE3 1
+#endif
+
+DEFINE_LOG_CATEGORY_STATIC(LogMultiverseImageKernels, Log, All);
+
+static FORCEINLINE uint16 ConvertDepthValue(float Depth, const FMultiverseDepthConversion &DepthConversion, float MaxValue)
+{
+	if (!(Depth >= DepthConversion.MinDepth && Depth <= DepthConversion.MaxDepth))
+	{
+		return 0;
+	}
+	return static_cast<uint16>(FMath::Min(Depth * DepthConversion.Scale + 0.5f, MaxValue));
+}
+
+static void PackRGBScalar(const uint8 *Pixels, bool bIsBGRA, int32 Num, uint8 *OutRGB)
+{
+	const int32 RedIndex = bIsBGRA ? 2 : 0;
+	const int32 BlueIndex = bIsBGRA ? 0 : 2;
+	for (int32 PixelIndex = 0; PixelIndex < Num; PixelIndex++, Pixels += 4)
+	{
+		*OutRGB++ = Pixels[RedIndex];
+		*OutRGB++ = Pixels[1];
+		*OutRGB++ = Pixels[BlueIndex];
+	}
+}
+
+static void ConvertDepthToUint16Scalar(const float *Depth, int32 Stride, int32 Num, const FMultiverseDepthConversion &DepthConversion, uint16 *OutDepth)
+{
+	const float MaxValue = static_cast<float>(MAX_uint16);
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		OutDepth[Index] = ConvertDepthValue(Depth[Index * Stride], DepthConversion, MaxValue);
+	}
+}
+
+static void ConvertDepthToUint16Scalar(const FFloat16 *Depth, int32 Stride, int32 Num, const FMultiverseDepthConversion &DepthConversion, uint16 *OutDepth)
+{
+	const float MaxValue = static_cast<float>(MAX_uint16);
+	for (int32 Index = 0; Index < Num; Index++)
+	{
+		OutDepth[Index] = ConvertDepthValue(Depth[Index * Stride].GetFloat(), DepthConversion, MaxValue);
+	}
+}
+
+#if MULTIVERSE_IMAGE_KERNELS_SSSE3
+static bool HasSSSE3()
+{
+#if PLATFORM_ALWAYS_HAS_SSE4_1
+	return true;
+#else
+	static const bool bHasSSSE3 = []()
+	{
+		// CPUID leaf 1, bit 9 of ECX
+#ifdef _MSC_VER
+		int CpuInfo[4] = {};
+		__cpuid(CpuInfo, 1);
+		return (CpuInfo[2] & (1 << 9)) != 0;
+#else
+		unsigned int Eax = 0, Ebx = 0, Ecx = 0, Edx = 0;
+		return __get_cpuid(1, &Eax, &Ebx, &Ecx, &Edx) != 0 && (Ecx & (1 << 9)) != 0;
+#endif
+	}();
+	return bHasSSSE3;
+#endif
+}
+
+/** 16 pixels per iteration: every shuffle packs 4 pixels into the low 12 bytes, three stores write 48 bytes. Returns the pixels packed */
+static MULTIVERSE_SSSE3_TARGET int32 PackRGBSSSE3(const uint8 *Pixels, bool bIsBGRA, int32 Num, uint8 *OutRGB)
+{
+	const __m128i Shuffle = bIsBGRA ? _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)
+									: _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+	int32 PixelIndex = 0;
+	for (; PixelIndex + 16 <= Num; PixelIndex += 16, Pixels += 64, OutRGB += 48)
+	{
+		const __m128i A = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pixels)), Shuffle);
+		const __m128i B = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pixels + 16)), Shuffle);
+		const __m128i C = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pixels + 32)), Shuffle);
+		const __m128i D = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(Pixels + 48)), Shuffle);
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(OutRGB), _mm_or_si128(A, _mm_slli_si128(B, 12)));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(OutRGB + 16), _mm_or_si128(_mm_srli_si128(B, 4), _mm_slli_si128(C, 8)));
+		_mm_storeu_si128(reinterpret_cast<__m128i *>(OutRGB + 32), _mm_or_si128(_mm_srli_si128(C, 8), _mm_slli_si128(D, 4)));
+	}
+	return PixelIndex;
+}
+#endif
+
+/** Constants of the vectorized depth conversion */
+struct FDepthVectorConstants
+{
+	explicit FDepthVectorConstants(const FMultiverseDepthConversion &DepthConversion)
+		: Scale(VectorSetFloat1(DepthConversion.Scale)),
+		  MinDepth(VectorSetFloat1(DepthConversion.MinDepth)),
+		  MaxDepth(VectorSetFloat1(DepthConversion.MaxDepth)),
+		  MaxValue(VectorSetFloat1(static_cast<float>(MAX_uint16))),
+		  Half(VectorSetFloat1(0.5f))
+	{
+	}
+
+	VectorRegister4Float Scale;
+	VectorRegister4Float MinDepth;
+	VectorRegister4Float MaxDepth;
+	VectorRegister4Float MaxValue;
+	VectorRegister4Float Half;
+};
+
+/** Convert 4 depth values, lanes not set in ValidMask and depth out of range end up as 0 */
+static FORCEINLINE void StoreDepthVector(const VectorRegister4Float &Depth, const VectorRegister4Float &ValidMask, const FDepthVectorConstants &Constants, uint16 *OutDepth)
+{
+	// Comparisons with NaN are false, so invalid depth ends up as 0 like out of range depth
+	const VectorRegister4Float Mask = VectorBitwiseAnd(ValidMask, VectorBitwiseAnd(VectorCompareGE(Depth, Constants.MinDepth), VectorCompareLE(Depth, Constants.MaxDepth)));
+	const VectorRegister4Float Value = VectorSelect(Mask, VectorMin(VectorMultiplyAdd(Depth, Constants.Scale, Constants.Half), Constants.MaxValue), VectorZeroFloat());
+
+	alignas(16) int32 Values[4];
+	VectorIntStoreAligned(VectorFloatToInt(Value), Values);
+	OutDepth[0] = static_cast<uint16>(Values[0]);
+	OutDepth[1] = static_cast<uint16>(Values[1]);
+	OutDepth[2] = static_cast<uint16>(Values[2]);
+	OutDepth[3] = static_cast<uint16>(Values[3]);
+}
+
+void MultiverseImageKernels::PackRGB(const uint8 *Pixels, bool bIsBGRA, int32 Num, uint8 *OutRGB)
+{
+	int32 PixelIndex = 0;
+#if MULTIVERSE_IMAGE_KERNELS_SSSE3
+	if (HasSSSE3())
+	{
+		PixelIndex = PackRGBSSSE3(Pixels, bIsBGRA, Num, OutRGB);
+	}
+#elif MULTIVERSE_IMAGE_KERNELS_NEON
+	for (; PixelIndex + 16 <= Num; PixelIndex += 16)
+	{
+		const uint8x16x4_t Channels = vld4q_u8(Pixels + PixelIndex * 4);
+		uint8x16x3_t RGB;
+		RGB.val[0] = bIsBGRA ? Channels.val[2] : Channels.val[0];
+		RGB.val[1] = Channels.val[1];
+		RGB.val[2] = bIsBGRA ? Channels.val[0] : Channels.val[2];
+		vst3q_u8(OutRGB + PixelIndex * 3, RGB);
+	}
+#endif
+
+	PackRGBScalar(Pixels + PixelIndex * 4, bIsBGRA, Num - PixelIndex, OutRGB + PixelIndex * 3);
+}
+
+void MultiverseImageKernels::ConvertDepthToUint16(const float *Depth, int32 Stride, int32 Num, const FMultiverseDepthConversion &DepthConversion, uint16 *OutDepth)
+{
+	const FDepthVectorConstants Constants(DepthConversion);
+	const VectorRegister4Float AllValid = VectorCastIntToFloat(VectorIntSet1(-1));
+	int32 Index = 0;
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		const VectorRegister4Float DepthVector = Stride == 1 ? VectorLoad(Depth + Index)
+															: MakeVectorRegisterFloat(Depth[Index * Stride], Depth[(Index + 1) * Stride], Depth[(Index + 2) * Stride], Depth[(Index + 3) * Stride]);
+		StoreDepthVector(DepthVector, AllValid, Constants, OutDepth + Index);
+	}
+
+	ConvertDepthToUint16Scalar(Depth + Index * Stride, Stride, Num - Index, DepthConversion, OutDepth + Index);
+}
+
+void MultiverseImageKernels::ConvertDepthToUint16(const FFloat16 *Depth, int32 Stride, int32 Num, const FMultiverseDepthConversion &DepthConversion, uint16 *OutDepth)
+{
+	// Half to float with integer operations: shifting exponent and mantissa into place and multiplying by 2^112 rebiases the exponent,
+	// which also turns denormals into the right normal floats. Infinity and NaN (exponent 31) are masked out.
+	const FDepthVectorConstants Constants(DepthConversion);
+	const VectorRegister4Int AbsMask = VectorIntSet1(0x7FFF);
+	const VectorRegister4Int SignMask = VectorIntSet1(0x8000);
+	const VectorRegister4Int InfinityBits = VectorIntSet1(0x7C00);
+	const VectorRegister4Float Rebias = VectorSetFloat1(5.192296858534828e+33f);
+	int32 Index = 0;
+	for (; Index + 4 <= Num; Index += 4)
+	{
+		const VectorRegister4Int Bits = MakeVectorRegisterInt(Depth[Index * Stride].Encoded, Depth[(Index + 1) * Stride].Encoded, Depth[(Index + 2) * Stride].Encoded, Depth[(Index + 3) * Stride].Encoded);
+		const VectorRegister4Int AbsBits = VectorIntAnd(Bits, AbsMask);
+		const VectorRegister4Float Magnitude = VectorMultiply(VectorCastIntToFloat(VectorShiftLeftImm(AbsBits, 13)), Rebias);
+		const VectorRegister4Float Sign = VectorCastIntToFloat(VectorShiftLeftImm(VectorIntAnd(Bits, SignMask), 16));
+		const VectorRegister4Float ValidMask = VectorCastIntToFloat(VectorIntCompareGT(InfinityBits, AbsBits));
+		StoreDepthVector(VectorBitwiseOr(Magnitude, Sign), ValidMask, Constants, OutDepth + Index);
+	}
+
+	ConvertDepthToUint16Scalar(Depth + Index * Stride, Stride, Num - Index, DepthConversion, OutDepth + Index);
+}
+
+static float FloatFromBits(uint32 Bits)
+{
+	float Value;
+	FMemory::Memcpy(&Value, &Bits, sizeof(float));
+	return Value;
+}
+
+/** Compare the kernels with their scalar versions on every tail length, both strides, and special and denormal values */
+static bool VerifyImageKernels()
+{
+	const FMultiverseDepthConversion DepthConversion;
+	// Every length up to a few vector widths runs the vector loops with all scalar remainders
+	const int32 MaxNum = 67;
+	const int32 Strides[] = {1, 4};
+	const uint16 Guard = 0xCDCD;
+
+	TArray<uint8> Pixels;
+	Pixels.SetNumUninitialized(MaxNum * 4);
+	for (int32 Index = 0; Index < Pixels.Num(); Index++)
+	{
+		Pixels[Index] = static_cast<uint8>(Index * 37 + 11);
+	}
+	for (const bool bIsBGRA : {true, false})
+	{
+		for (int32 Num = 0; Num <= MaxNum; Num++)
+		{
+			// The byte past the end catches stores beyond Num pixels
+			TArray<uint8> RGB;
+			TArray<uint8> ExpectedRGB;
+			RGB.Init(0xCD, Num * 3 + 1);
+			ExpectedRGB.Init(0xCD, Num * 3 + 1);
+			MultiverseImageKernels::PackRGB(Pixels.GetData(), bIsBGRA, Num, RGB.GetData());
+			PackRGBScalar(Pixels.GetData(), bIsBGRA, Num, ExpectedRGB.GetData());
+			if (RGB != ExpectedRGB)
+			{
+				UE_LOG(LogMultiverseImageKernels, Error, TEXT("PackRGB differs from the scalar version for %d %s pixels"), Num, bIsBGRA ? TEXT("BGRA") : TEXT("RGBA"))
+				return false;
+			}
+		}
+	}
+
+	// A fused multiply-add in the vector path may round values at exactly .5 the other way
+	auto CompareDepth = [Guard](const TCHAR *KernelName, int32 Stride, const TArray<uint16> &OutDepth, const TArray<uint16> &ExpectedDepth)
+	{
+		for (int32 Index = 0; Index < OutDepth.Num(); Index++)
+		{
+			const bool bIsGuard = Index == OutDepth.Num() - 1;
+			if (bIsGuard ? OutDepth[Index] != Guard : FMath::Abs(OutDepth[Index] - ExpectedDepth[Index]) > 1)
+			{
+				UE_LOG(LogMultiverseImageKernels, Error, TEXT("%s with stride %d differs from the scalar version at %d of %d: %d != %d"),
+					   KernelName, Stride, Index, OutDepth.Num() - 1, OutDepth[Index], ExpectedDepth[Index])
+				return false;
+			}
+		}
+		return true;
+	};
+
+	const float SpecialDepths[] = {0.f, -0.f, -1.f, 0.04f, 0.05f, 0.15f, 1.f, 100.25f, 6553.45f, 6553.5f, 6553.55f, 1.0e30f,
+								   FloatFromBits(0x00000001), FloatFromBits(0x007FFFFF), FloatFromBits(0x00800000),
+								   FloatFromBits(0x7F800000), FloatFromBits(0xFF800000), FloatFromBits(0x7FC00000), FloatFromBits(0x7F800001)};
+	for (const int32 Stride : Strides)
+	{
+		for (int32 Num = 0; Num <= MaxNum; Num++)
+		{
+			TArray<float> Depth;
+			Depth.SetNumUninitialized(Num * Stride);
+			for (int32 Index = 0; Index < Depth.Num(); Index++)
+			{
+				Depth[Index] = Index % 3 == 0 ? SpecialDepths[(Index / 3) % UE_ARRAY_COUNT(SpecialDepths)] : Index * 13.7f;
+			}
+			TArray<uint16> OutDepth;
+			TArray<uint16> ExpectedDepth;
+			OutDepth.Init(Guard, Num + 1);
+			ExpectedDepth.Init(Guard, Num + 1);
+			MultiverseImageKernels::ConvertDepthToUint16(Depth.GetData(), Stride, Num, DepthConversion, OutDepth.GetData());
+			ConvertDepthToUint16Scalar(Depth.GetData(), Stride, Num, DepthConversion, ExpectedDepth.GetData());
+			if (!CompareDepth(TEXT("Depth float"), Stride, OutDepth, ExpectedDepth))
+			{
+				return false;
+			}
+		}
+	}
+
+	// Every half: zeros, denormals, normals, infinities and NaNs of both signs, with a tail of 1 value
+	const int32 HalfNum = MAX_uint16 + 1;
+	for (const int32 Stride : Strides)
+	{
+		TArray<FFloat16> HalfDepth;
+		HalfDepth.SetNumZeroed(HalfNum * Stride);
+		for (int32 Index = 0; Index < HalfNum; Index++)
+		{
+			HalfDepth[Index * Stride].Encoded = static_cast<uint16>(Index);
+		}
+		for (const int32 Num : {HalfNum, HalfNum - 1})
+		{
+			TArray<uint16> OutDepth;
+			TArray<uint16> ExpectedDepth;
+			OutDepth.Init(Guard, Num + 1);
+			ExpectedDepth.Init(Guard, Num + 1);
+			MultiverseImageKernels::ConvertDepthToUint16(HalfDepth.GetData(), Stride, Num, DepthConversion, OutDepth.GetData());
+			ConvertDepthToUint16Scalar(HalfDepth.GetData(), Stride, Num, DepthConversion, ExpectedDepth.GetData());
+			if (!CompareDepth(TEXT("Depth half"), Stride, OutDepth, ExpectedDepth))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/** Throughput of the vectorized kernels against the scalar ones on synthetic images, CPU only, after checking that they agree */
+static void BenchmarkImageKernels(const TArray<FString> &Args)
+{
+#if MULTIVERSE_IMAGE_KERNELS_SSSE3
+	UE_LOG(LogMultiverseImageKernels, Display, TEXT("PackRGB runs %s"), HasSSSE3() ? TEXT("SSSE3") : TEXT("scalar"))
+#elif MULTIVERSE_IMAGE_KERNELS_NEON
+	UE_LOG(LogMultiverseImageKernels, Display, TEXT("PackRGB runs NEON"))
+#else
+	UE_LOG(LogMultiverseImageKernels, Display, TEXT("PackRGB runs scalar"))
+#endif
+	if (!VerifyImageKernels())
+	{
+		return;
+	}
+	UE_LOG(LogMultiverseImageKernels, Display, TEXT("The kernels match their scalar versions"))
+
+	const int32 Iterations = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 20;
+	const FIntPoint Resolutions[] = {{128, 128}, {640, 480}, {1280, 1024}, {3840, 2160}};
+	const FMultiverseDepthConversion DepthConversion;
+
+	auto Measure = [Iterations](const TCHAR *KernelName, const FIntPoint &Resolution, int64 InputSize, TFunctionRef<void()> Kernel)
+	{
+		Kernel();
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			Kernel();
+		}
+		const double Seconds = (FPlatformTime::Seconds() - StartTime) / Iterations;
+		UE_LOG(LogMultiverseImageKernels, Display, TEXT("%-18s %4dx%-4d: %8.3f ms, %6.2f GB/s"), KernelName, Resolution.X, Resolution.Y, Seconds * 1000.0, InputSize / Seconds / 1.0e9)
+	};
+
+	for (const FIntPoint &Resolution : Resolutions)
+	{
+		const int32 PixelNum = Resolution.X * Resolution.Y;
+		TArray<uint8> BGRA;
+		BGRA.SetNumUninitialized(PixelNum * 4);
+		for (int32 Index = 0; Index < BGRA.Num(); Index++)
+		{
+			BGRA[Index] = static_cast<uint8>(Index * 7);
+		}
+		TArray<float> Depth;
+		TArray<FFloat16> HalfDepth;
+		Depth.SetNumUninitialized(PixelNum);
+		HalfDepth.SetNumUninitialized(PixelNum);
+		for (int32 Index = 0; Index < PixelNum; Index++)
+		{
+			Depth[Index] = (Index % 1000) * 0.5f;
+			HalfDepth[Index] = Depth[Index];
+		}
+		TArray<uint8> RGB;
+		TArray<uint16> OutDepth;
+		RGB.SetNumUninitialized(PixelNum * 3);
+		OutDepth.SetNumUninitialized(PixelNum);
+
+		Measure(TEXT("PackRGB scalar"), Resolution, BGRA.Num(), [&]()
+				{ PackRGBScalar(BGRA.GetData(), true, PixelNum, RGB.GetData()); });
+		Measure(TEXT("PackRGB"), Resolution, BGRA.Num(), [&]()
+				{ MultiverseImageKernels::PackRGB(BGRA.GetData(), true, PixelNum, RGB.GetData()); });
+		Measure(TEXT("Depth float scalar"), Resolution, PixelNum * sizeof(float), [&]()
+				{ ConvertDepthToUint16Scalar(Depth.GetData(), 1, PixelNum, DepthConversion, OutDepth.GetData()); });
+		Measure(TEXT("Depth float"), Resolution, PixelNum * sizeof(float), [&]()
+				{ MultiverseImageKernels::ConvertDepthToUint16(Depth.GetData(), 1, PixelNum, DepthConversion, OutDepth.GetData()); });
+		Measure(TEXT("Depth half scalar"), Resolution, PixelNum * sizeof(FFloat16), [&]()
+				{ ConvertDepthToUint16Scalar(HalfDepth.GetData(), 1, PixelNum, DepthConversion, OutDepth.GetData()); });
+		Measure(TEXT("Depth half"), Resolution, PixelNum * sizeof(FFloat16), [&]()
+				{ MultiverseImageKernels::ConvertDepthToUint16(HalfDepth.GetData(), 1, PixelNum, DepthConversion, OutDepth.GetData()); });
+	}
+}
+
+static FAutoConsoleCommand BenchmarkImageKernelsCommand(
+	TEXT("Multiverse.BenchmarkImageKernels"),
+	TEXT("Check the image kernels against their scalar versions, then log their throughput at every camera resolution. Optional argument: iterations (default 20)"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkImageKernels));
@@ -0,0 +1,101 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#include "MultiverseJitterBuffer.h"
+
+void FMultiverseJitterBuffer::Reset(int32 InCapacity)
+{
+	Samples.Reset();
+	Capacity = FMath::Max(InCapacity, 2);
+}
+
+void FMultiverseJitterBuffer::Push(double Time, const double *Data, int32 Num)
+{
+	if (Samples.Num() > 0)
+	{
+		if (Samples.Last().Data.Num() != Num || Time < Samples.Last().Time - KINDA_SMALL_NUMBER)
+		{
+			// The layout changed after a new handshake or the server time restarted, the older samples cannot be interpolated anymore
+			Samples.Reset();
+		}
+		else if (Time <= Samples.Last().Time + KINDA_SMALL_NUMBER)
+		{
+			// The server did not step since the last exchange
+			return;
+		}
+	}
+
+	FSample Sample;
+	if (Samples.Num() >= Capacity)
+	{
+		Sample = MoveTemp(Samples[0]);
+		Samples.RemoveAt(0);
+	}
+	Sample.Time = Time;
+	Sample.Data.SetNumUninitialized(Num);
+	FMemory::Memcpy(Sample.Data.GetData(), Data, Num * sizeof(double));
+	Samples.Add(MoveTemp(Sample));
+}
+
+bool FMultiverseJitterBuffer::Sample(double Time, double MaxExtrapolationTime, const TArray<FMultiverseInterpolationSlot> &Slots, TArray<double> &OutData) const
+{
+	if (Samples.Num() == 0)
+	{
+		return false;
+	}
+
+	if (Samples.Num() == 1)
+	{
+		OutData = Samples[0].Data;
+		return true;
+	}
+
+	int32 IndexA = Samples.Num() - 2;
+	while (IndexA > 0 && Samples[IndexA].Time > Time)
+	{
+		IndexA--;
+	}
+	const FSample &SampleA = Samples[IndexA];
+	const FSample &SampleB = Samples[IndexA + 1];
+
+	// Past the latest sample the motion is extrapolated, but only for MaxExtrapolationTime
+	const double ClampedTime = FMath::Min(Time, Samples.Last().Time + MaxExtrapolationTime);
+	const double Alpha = FMath::Max((ClampedTime - SampleA.Time) / (SampleB.Time - SampleA.Time), 0.0);
+
+	OutData = SampleB.Data;
+	for (const FMultiverseInterpolationSlot &Slot : Slots)
+	{
+		const double *DataA = SampleA.Data.GetData() + Slot.Offset;
+		const double *DataB = SampleB.Data.GetData() + Slot.Offset;
+		double *Data = OutData.GetData() + Slot.Offset;
+		switch (Slot.Interpolation)
+		{
+		case EMultiverseInterpolation::Linear:
+			for (int32 i = 0; i < Slot.Size; i++)
+			{
+				Data[i] = DataA[i] + (DataB[i] - DataA[i]) * Alpha;
+			}
+			break;
+
+		case EMultiverseInterpolation::AngleDegrees:
+			for (int32 i = 0; i < Slot.Size; i++)
+			{
+				Data[i] = DataA[i] + FMath::FindDeltaAngleDegrees(DataA[i], DataB[i]) * Alpha;
+			}
+			break;
+
+		case EMultiverseInterpolation::Quaternion:
+		{
+			const FQuat QuatA(DataA[1], DataA[2], DataA[3], DataA[0]);
+			const FQuat QuatB(DataB[1], DataB[2], DataB[3], DataB[0]);
+			const FQuat Quat = FQuat::Slerp_NotNormalized(QuatA, QuatB, Alpha).GetNormalized();
+			Data[0] = Quat.W;
+			Data[1] = Quat.X;
+			Data[2] = Quat.Y;
+			Data[3] = Quat.Z;
+			break;
+		}
+		}
+	}
+
+	return true;
+}
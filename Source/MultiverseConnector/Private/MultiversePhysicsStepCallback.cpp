@@ -0,0 +1,13 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#include "MultiversePhysicsStepCallback.h"
+
+#include "MultiverseClient.h"
+
+void FMultiversePhysicsStepCallback::OnPreSimulate_Internal()
+{
+	if (FMultiverseClient *StepClient = Client.load())
+	{
+		StepClient->CommunicatePhysicsStep();
+	}
+}
@@ -0,0 +1,75 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#include "MultiverseSkeletonJoints.h"
+
+#include "Animation/Skeleton.h"
+#include "Misc/ScopeRWLock.h"
+#include "UObject/ObjectKey.h"
+
+static FRWLock SkeletonJointsLock;
+
+static TMap<FObjectKey, TSharedPtr<const FMultiverseSkeletonJoints>> SkeletonJointsMap;
+
+static const TPair<const TCHAR *, EMultiverseJointType> JointSuffixes[] =
+	{
+		{TEXT("_revolute_bone"), EMultiverseJointType::Revolute},
+		{TEXT("_continuous_bone"), EMultiverseJointType::Continuous},
+		{TEXT("_prismatic_bone"), EMultiverseJointType::Prismatic},
+		{TEXT("_ball_bone"), EMultiverseJointType::Ball},
+		{TEXT("_free_bone"), EMultiverseJointType::Free}};
+
+bool FMultiverseSkeletonJoints::ClassifyBone(const FName &BoneName, EMultiverseJointType &OutType, FString &OutJointName)
+{
+	const FString BoneNameStr = BoneName.ToString();
+	for (const TPair<const TCHAR *, EMultiverseJointType> &JointSuffix : JointSuffixes)
+	{
+		if (BoneNameStr.EndsWith(JointSuffix.Key, ESearchCase::CaseSensitive))
+		{
+			OutType = JointSuffix.Value;
+			OutJointName = BoneNameStr.LeftChop(FCString::Strlen(JointSuffix.Key));
+			return true;
+		}
+	}
+	return false;
+}
+
+TSharedPtr<const FMultiverseSkeletonJoints> FMultiverseSkeletonJoints::Get(const USkeleton *Skeleton)
+{
+	if (Skeleton == nullptr)
+	{
+		return nullptr;
+	}
+
+	const FReferenceSkeleton &ReferenceSkeleton = Skeleton->GetReferenceSkeleton();
+	{
+		FReadScopeLock ReadScopeLock(SkeletonJointsLock);
+		const TSharedPtr<const FMultiverseSkeletonJoints> *SkeletonJoints = SkeletonJointsMap.Find(Skeleton);
+		if (SkeletonJoints != nullptr && (*SkeletonJoints)->BoneNum == ReferenceSkeleton.GetNum())
+		{
+			return *SkeletonJoints;
+		}
+	}
+
+	TSharedPtr<FMultiverseSkeletonJoints> SkeletonJoints = MakeShared<FMultiverseSkeletonJoints>();
+	SkeletonJoints->BoneNum = ReferenceSkeleton.GetNum();
+	for (int32 BoneIndex = 0; BoneIndex < ReferenceSkeleton.GetNum(); BoneIndex++)
+	{
+		FMultiverseSkeletonJoint Joint;
+		Joint.BoneName = ReferenceSkeleton.GetBoneName(BoneIndex);
+		Joint.BoneIndex = BoneIndex;
+		if (ClassifyBone(Joint.BoneName, Joint.Type, Joint.JointName))
+		{
+			SkeletonJoints->Joints.Add(MoveTemp(Joint));
+		}
+	}
+	SkeletonJoints->Joints.Sort([](const FMultiverseSkeletonJoint &JointA, const FMultiverseSkeletonJoint &JointB)
+								{ return JointB.BoneName.ToString().Compare(JointA.BoneName.ToString()) > 0; });
+	for (int32 JointIndex = 0; JointIndex < SkeletonJoints->Joints.Num(); JointIndex++)
+	{
+		SkeletonJoints->JointIndices.Add(SkeletonJoints->Joints[JointIndex].BoneName, JointIndex);
+	}
+
+	FWriteScopeLock WriteScopeLock(SkeletonJointsLock);
+	SkeletonJointsMap.Add(Skeleton, SkeletonJoints);
+	return SkeletonJoints;
+}
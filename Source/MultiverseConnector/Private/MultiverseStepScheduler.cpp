@@ -0,0 +1,48 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#include "MultiverseStepScheduler.h"
+
+void FMultiverseStepScheduler::Reset(EMultiverseCatchUpPolicy InCatchUpPolicy, int32 InMaxCatchUpSteps)
+{
+	CatchUpPolicy = InCatchUpPolicy;
+	MaxCatchUpSteps = FMath::Max(InMaxCatchUpSteps, 1);
+	AccumulatedTime = 0.0;
+	SkippedSteps = 0;
+	MeasuredRate = 0.0;
+	MeasureTime = 0.0;
+	MeasureSteps = 0;
+}
+
+void FMultiverseStepScheduler::SetRate(float Rate)
+{
+	StepTime = Rate > 0.f ? 1.0 / Rate : 0.0;
+}
+
+int32 FMultiverseStepScheduler::Advance(double DeltaTime)
+{
+	int32 Steps = 0;
+	if (StepTime > 0.0)
+	{
+		AccumulatedTime += FMath::Max(DeltaTime, 0.0);
+		const int64 DueSteps = FMath::FloorToInt64(AccumulatedTime / StepTime);
+		AccumulatedTime -= DueSteps * StepTime;
+
+		Steps = static_cast<int32>(FMath::Min<int64>(DueSteps, CatchUpPolicy == EMultiverseCatchUpPolicy::CatchUp ? MaxCatchUpSteps : 1));
+		SkippedSteps += DueSteps - Steps;
+	}
+	else
+	{
+		AccumulatedTime = 0.0;
+	}
+
+	MeasureTime += DeltaTime;
+	MeasureSteps += Steps;
+	if (MeasureTime >= 1.0)
+	{
+		MeasuredRate = MeasureSteps / MeasureTime;
+		MeasureTime = 0.0;
+		MeasureSteps = 0;
+	}
+
+	return Steps;
+}
@@ -31,5 +31,20 @@ private:
 	virtual void InitializeBoneReferences(const FBoneContainer& RequiredBones) override;
 	// End of FAnimNode_SkeletalControlBase interface
 
+	/** Joints in compact pose order, parents come before their children */
 	TArray<FBoneReference> BonesToModify;
+
+	/** Joint name per compact pose bone index, NAME_None for bones that are not joints */
+	TArray<FName> JointNames;
+
+	/** Index into the joint state of JointStateOwner per compact pose bone index */
+	TArray<int32> JointStateIndices;
+
+	const class UMultiverseAnim* JointStateOwner = nullptr;
+
+	/** Component space transforms with the joint poses applied, per compact pose bone index */
+	TArray<FTransform> ModifiedTransforms;
+
+	/** Bones whose transform or one of whose parents' transform was modified in this evaluation */
+	TBitArray<> ModifiedBones;
 };
@@ -3,10 +3,22 @@
 #pragma once
 
 #include "Animation/AnimInstance.h"
+#include "Containers/TripleBuffer.h"
+#include "MultiverseSkeletonJoints.h"
 // clang-format off
 #include "MultiverseAnim.generated.h"
 // clang-format on
 
+/** Joint poses published by the game thread for the animation worker threads */
+struct FMultiverseJointState
+{
+	/** Indexed like UMultiverseAnim::GetJointNames */
+	TArray<FTransform> JointPoses;
+
+	/** Incremented with every publish, 0 until the first one */
+	uint64 Sequence = 0;
+};
+
 UCLASS()
 class MULTIVERSECONNECTOR_API UMultiverseAnim : public UAnimInstance
 {
@@ -16,11 +28,65 @@ public:
 	UMultiverseAnim();
 
 public:
+	virtual void NativeInitializeAnimation() override;
+
 	virtual void NativeBeginPlay() override;
 
 	virtual void NativeUpdateAnimation(float DeltaSeconds) override;
 
 public:
+	/** Joint bones of the skeleton in the order of the joint state, must be called from the game thread */
+	const TArray<FName>& GetJointNames();
+
+	/** Joints of the skeleton, shared with every instance of the same skeleton, must be called from the game thread */
+	const FMultiverseSkeletonJoints* GetSkeletonJoints();
+
+	/** Index of a joint in the joint state, INDEX_NONE if the bone is not a joint, must be called from the game thread */
+	int32 GetJointIndex(const FName& JointName);
+
+	const FTransform& GetJointPose(int32 JointIndex) const { return PendingJointPoses[JointIndex]; }
+
+	/** Joint pose that is published with the next animation update, must be called from the game thread */
+	FTransform& EditJointPose(int32 JointIndex)
+	{
+		bJointStateDirty = true;
+		return PendingJointPoses[JointIndex];
+	}
+
+	/** All joint poses for a bulk write, published with the next animation update, must be called from the game thread */
+	TArrayView<FTransform> EditJointPoses()
+	{
+		bJointStateDirty = true;
+		return PendingJointPoses;
+	}
+
+	/** Newest published joint state, called by the node that evaluates this instance on an animation worker thread */
+	const FMultiverseJointState& ReadJointState();
+
+	/** Index of a joint in the published joint state, safe from any thread once the joints are initialized */
+	int32 FindJointIndex(const FName& JointName) const;
+
+public:
+	/** Initial joint poses for the pin of the Modify Bones node, the streamed joint poses are in the joint state */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TMap<FName, FTransform> JointPoses;
+
+private:
+	void InitJoints();
+
+	void PublishJointState();
+
+private:
+	TSharedPtr<const FMultiverseSkeletonJoints> SkeletonJoints;
+
+	TArray<FName> JointNames;
+
+	TArray<FTransform> PendingJointPoses;
+
+	bool bJointStateDirty = false;
+
+	uint64 JointStateSequence = 0;
+
+	/** Three buffers, so that publishing never waits for an evaluation that still reads the previous state */
+	TTripleBuffer<FMultiverseJointState> JointStates;
 };
@@ -0,0 +1,104 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "MultiverseImageEncoder.h"
+#include "PixelFormat.h"
+#include <atomic>
+
+class FRHIGPUTextureReadback;
+class UTextureRenderTarget2D;
+
+/** Pixels of one captured frame, rows are tightly packed */
+struct FMultiverseCameraFrame
+{
+	TArray<uint8> Pixels;
+
+	EPixelFormat Format = PF_Unknown;
+
+	/** Pixels hold the encoded image of Format if not None */
+	EMultiverseImageEncoding Encoding = EMultiverseImageEncoding::None;
+
+	int32 Width = 0;
+
+	int32 Height = 0;
+
+	/** World time at which the copy of the render target was requested */
+	double WorldTime = 0.0;
+};
+
+/**
+ * Ring of in-flight GPU readbacks of a scene capture render target.
+ * The game thread requests a copy after each capture and picks up the newest frame whose readback completed,
+ * the rendering thread is never flushed. If all slots are still in flight the new copy is skipped.
+ * Without asynchronous readbacks the render target is read with a blocking ReadPixels instead.
+ */
+class MULTIVERSECONNECTOR_API FMultiverseCameraReadback : public TSharedFromThis<FMultiverseCameraReadback, ESPMode::ThreadSafe>
+{
+public:
+	explicit FMultiverseCameraReadback(int32 InRingSize = 3, bool bInAsyncReadback = true);
+
+	~FMultiverseCameraReadback();
+
+public:
+	/** Request a copy of the render target if bCopy and poll the copies in flight, must be called from the game thread */
+	void Update(UTextureRenderTarget2D *TextureTarget, double WorldTime, bool bCopy = true);
+
+	/** Run on a worker thread for every frame picked up, e.g. to convert depth, before it becomes the latest frame */
+	void SetFrameProcessor(TFunction<void(const FMultiverseCameraFrame &, FMultiverseCameraFrame &)> InFrameProcessor) { FrameProcessor = MoveTemp(InFrameProcessor); }
+
+	/** Newest completed frame, kept with its original WorldTime until a newer one completes, empty until the first readback completes */
+	const FMultiverseCameraFrame &GetLatestFrame() const { return LatestFrame; }
+
+	/** Blocking copy through ReadPixels, float render targets keep their precision */
+	static bool ReadPixels(UTextureRenderTarget2D *TextureTarget, double WorldTime, FMultiverseCameraFrame &OutFrame);
+
+	/** Whether the current RHI can complete asynchronous readbacks */
+	static bool IsSupported();
+
+private:
+	enum class ESlotState : uint8
+	{
+		Free,
+		InFlight,
+		Ready,
+		Processing,
+		Processed
+	};
+
+	struct FSlot
+	{
+		TUniquePtr<FRHIGPUTextureReadback> Readback;
+
+		std::atomic<ESlotState> State = ESlotState::Free;
+
+		uint64 Sequence = 0;
+
+		FMultiverseCameraFrame Frame;
+
+		FMultiverseCameraFrame ProcessedFrame;
+	};
+
+	void ProcessReadyFrame();
+
+	void PollReadbacks_RenderThread();
+
+private:
+	TFunction<void(const FMultiverseCameraFrame &, FMultiverseCameraFrame &)> FrameProcessor;
+
+	TArray<TUniquePtr<FSlot>> Slots;
+
+	bool bAsyncReadback = true;
+
+	/** Frame read by ReadPixels before it is processed */
+	FMultiverseCameraFrame ReadPixelsFrame;
+
+	int32 NextSlot = 0;
+
+	uint64 NextSequence = 1;
+
+	uint64 LatestSequence = 0;
+
+	FMultiverseCameraFrame LatestFrame;
+};
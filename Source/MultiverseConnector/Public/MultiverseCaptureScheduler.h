@@ -0,0 +1,39 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Decides which cameras render in a frame. Every camera has its own capture rate, due cameras are picked
+ * round-robin so that at most MaxCapturesPerFrame scene captures are rendered per frame.
+ */
+class MULTIVERSECONNECTOR_API FMultiverseCaptureScheduler
+{
+public:
+	/** 0 captures every due camera in the same frame */
+	void Reset(int32 InMaxCapturesPerFrame = 0);
+
+	/** Add a camera captured CaptureRate times per second, 0 captures it every frame, returns its index */
+	int32 AddCamera(float CaptureRate);
+
+	/** Mark the cameras that capture at WorldTime in OutDueCameras */
+	void Schedule(double WorldTime, TArray<bool> &OutDueCameras);
+
+	int32 Num() const { return Cameras.Num(); }
+
+private:
+	struct FCamera
+	{
+		double CaptureInterval = 0.0;
+
+		double NextCaptureTime = 0.0;
+	};
+
+	TArray<FCamera> Cameras;
+
+	int32 MaxCapturesPerFrame = 0;
+
+	/** Camera checked first in the next frame */
+	int32 NextCamera = 0;
+};
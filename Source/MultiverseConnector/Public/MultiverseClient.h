@@ -3,6 +3,17 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Async/Future.h"
+#include "Containers/TripleBuffer.h"
+#include "Engine/EngineTypes.h"
+#include "Engine/TextureRenderTarget2D.h"
+#include "MultiverseCaptureScheduler.h"
+#include "MultiverseClockEstimator.h"
+#include "MultiverseCommunicationThread.h"
+#include "MultiverseImageEncoder.h"
+#include "MultiverseImageKernels.h"
+#include "MultiverseJitterBuffer.h"
+#include <atomic>
 THIRD_PARTY_INCLUDES_START
 #include "ThirdParty/MultiverseClientLibrary/multiverse_client.h"
 THIRD_PARTY_INCLUDES_END
@@ -20,6 +31,7 @@ enum class EAttribute : uint8
 	CmdJointLinearPosition,
 	CmdJointLinearVelocity,
 	CmdJointTorque,
+	Depth,
 	Depth_1280_1024,
 	Depth_128_128,
 	Depth_3840_2160,
@@ -36,6 +48,7 @@ enum class EAttribute : uint8
 	LinearVelocity,
 	Position,
 	Quaternion,
+	RGB,
 	RGB_1280_1024,
 	RGB_128_128,
 	RGB_3840_2160,
@@ -44,6 +57,35 @@ enum class EAttribute : uint8
 	Torque,
 };
 
+/** Image stream of a scene capture, sent as rgb_<Width>_<Height> (uint8 RGB) or depth_<Width>_<Height> (uint16) */
+USTRUCT(Blueprintable)
+struct FMultiverseSensorDescriptor
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1))
+	int32 Width = 640;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 1))
+	int32 Height = 480;
+
+	/** Without an override RGB is captured as RGBA8 scene color and depth as R32f scene depth */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (InlineEditConditionToggle))
+	bool bOverrideFormat = false;
+
+	/** Format of the render target, depth is read from its red channel */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bOverrideFormat"))
+	TEnumAsByte<ETextureRenderTargetFormat> Format = ETextureRenderTargetFormat::RTF_RGBA8;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (EditCondition = "bOverrideFormat"))
+	TEnumAsByte<ESceneCaptureSource> CaptureSource = ESceneCaptureSource::SCS_SceneColorHDR;
+
+	/** Captures per second, 0 captures on every exchange. The latest frame is sent again in between */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = 0))
+	float CaptureRate = 0.f;
+};
+
 USTRUCT(Blueprintable)
 struct FAttributeContainer
 {
@@ -61,6 +103,10 @@ public:
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TArray<EAttribute> Attributes;
+
+	/** Resolution and format of the RGB and Depth attributes, 640x480 if not set */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TMap<EAttribute, FMultiverseSensorDescriptor> Sensors;
 };
 
 USTRUCT(Blueprintable)
@@ -106,11 +152,275 @@ public:
 	TArray<FApiCallback> ApiCallbacks;
 };
 
+struct FMultiverseClientSettings
+{
+	/** Run the blocking send/receive round-trip on a dedicated thread instead of the game thread */
+	bool bAsyncCommunication = false;
+
+	/**
+	 * Run the round-trip on the physics thread before every physics substep. Position, quaternion and velocities of
+	 * simulated actors are read from and force, torque and velocities written to the Chaos particles, the other data
+	 * is gathered and applied by Communicate. Needs async physics to be independent of the frame rate.
+	 */
+	bool bPhysicsStepCommunication = false;
+
+	/**
+	 * Exchange once per frame and advance the next frame by exactly the time the server stepped in between,
+	 * through a fixed engine time step. The world then runs as fast as the server steps instead of at wall clock pace.
+	 * Needs synchronous communication.
+	 */
+	bool bLockstep = false;
+
+	/** Seconds a frame polls a server that does not step in lockstep, the world tick is skipped by pausing after that */
+	double LockstepTimeout = 0.1;
+
+	/** Gather the send data on the task graph once there are at least this many bindings */
+	int32 ParallelGatherThreshold = 256;
+
+	/** Teleport flag of the single location and rotation update per received actor */
+	ETeleportType ReceiveTeleportType = ETeleportType::None;
+
+	/** Apply received poses every frame, interpolated between the buffered samples instead of once per exchange */
+	bool bInterpolateReceiveData = false;
+
+	/** Render received poses this many seconds of server time in the past, so that there is a sample on both sides */
+	double InterpolationDelay = 0.1;
+
+	/** How long the poses keep moving past the latest sample when packets are late */
+	double MaxExtrapolationTime = 0.05;
+
+	int32 JitterBufferSize = 8;
+
+	/** Read the camera render targets back through a ring of GPU readbacks instead of a blocking ReadPixels */
+	bool bAsyncCameraReadback = true;
+
+	/** Readbacks in flight per camera, a new frame is skipped when all of them are still pending */
+	int32 CameraReadbackRingSize = 3;
+
+	/** Conversion of the scene depth to the uint16 depth images */
+	FMultiverseDepthConversion DepthConversion;
+
+	/** Scene captures rendered per frame at most, due cameras are picked round-robin, 0 renders all due cameras */
+	int32 MaxCapturesPerFrame = 0;
+
+	/** Encoding of the camera images, applied on worker threads when the readbacks are asynchronous */
+	EMultiverseImageEncoding ImageEncoding = EMultiverseImageEncoding::None;
+
+	/** JPEG quality from 1 to 100 */
+	int32 ImageEncodingQuality = 85;
+
+	/** Encoded images get a slot of the raw image size divided by this, 0 sizes the slots for the worst case of the encoding, the server is told the slot sizes in image_slot_sizes */
+	int32 ImageCompressionRatio = 0;
+};
+
+/** Copy of the send or receive buffers handed over between the game thread and the communication thread */
+struct FMultiverseBufferSnapshot
+{
+	TArray<double> BufferDouble;
+
+	TArray<uint8_t> BufferUint8;
+
+	TArray<uint16_t> BufferUint16;
+
+	/** world_time of the buffers, for the receive buffers the server time they were sampled at */
+	double WorldTime = 0.0;
+};
+
+/** Values of one object attribute in the send or receive part of the response meta data */
+struct FMultiverseResponseAttribute
+{
+	/** Index into FMultiverseResponseData::ObjectNames */
+	int32 ObjectIndex = INDEX_NONE;
+
+	EAttribute Attribute = EAttribute::Position;
+
+	int32 ValueOffset = 0;
+
+	int32 ValueNum = 0;
+};
+
+/**
+ * Send or receive part of the response meta data, read in one pass over the response string
+ * without building JSON objects. Only the values of double attributes are kept, the others are counted.
+ */
+struct FMultiverseResponseData
+{
+	TArray<FString> ObjectNames;
+
+	TArray<FMultiverseResponseAttribute> Attributes;
+
+	TArray<double> Values;
+
+	size_t DoubleNum = 0;
+
+	size_t Uint8Num = 0;
+
+	size_t Uint16Num = 0;
+
+	void Reset()
+	{
+		ObjectNames.Reset();
+		Attributes.Reset();
+		Values.Reset();
+		DoubleNum = 0;
+		Uint8Num = 0;
+		Uint16Num = 0;
+	}
+};
+
+/** API call waiting to be sent or for the response of the simulator, calls sent with the same handshake share its api_callbacks */
+struct FMultiverseApiCall
+{
+	uint32 Id = 0;
+
+	TMap<FString, FApiCallbacks> SimulationApiCallbacks;
+
+	/** Index of the first callback of this call in the api_callbacks of each simulation */
+	TMap<FString, int32> CallbackOffsets;
+
+	TPromise<TMap<FString, FApiCallbacks>> Promise;
+
+	double Timeout = 0.0;
+
+	double DispatchTime = -1.0;
+};
+
+enum class EMultiverseBindingType : uint8
+{
+	None,
+	CustomObject,
+	Actor,
+	SceneComponent,
+	SceneCapture,
+	Bone,
+	HandBone
+};
+
+/** Joint of an anim instance, with the actor owning the instance to drop it without touching the instance */
+struct FMultiverseAnimJoint
+{
+	class UMultiverseAnim *Anim = nullptr;
+
+	/** Index in the joint state of Anim */
+	int32 JointIndex = INDEX_NONE;
+
+	AActor *Actor = nullptr;
+};
+
+/**
+ * Entry of SendDataArray/ReceiveDataArray resolved once after init_send_and_receive_data,
+ * so that the per-frame data exchange is a linear walk without name lookups
+ */
+struct FMultiverseBinding
+{
+	EMultiverseBindingType Type = EMultiverseBindingType::None;
+
+	EAttribute Attribute = EAttribute::Position;
+
+	int32 DoubleOffset = 0;
+
+	int32 Uint8Offset = 0;
+
+	int32 Uint16Offset = 0;
+
+	AActor *Actor = nullptr;
+
+	class UPrimitiveComponent *PrimitiveComponent = nullptr;
+
+	class USceneComponent *SceneComponent = nullptr;
+
+	class USceneCaptureComponent2D *SceneCaptureComponent = nullptr;
+
+	/** Not set when the render target is read back with ReadPixels */
+	TSharedPtr<class FMultiverseCameraReadback, ESPMode::ThreadSafe> CameraReadback;
+
+	/** Resolution of the image sent for RGB and Depth attributes */
+	FIntPoint ImageSize = FIntPoint::ZeroValue;
+
+	/** Buffer values reserved for the image, fewer than the raw image when it is encoded */
+	int32 ImageSlotSize = 0;
+
+	float CaptureRate = 0.f;
+
+	/** Index of the camera in the capture scheduler */
+	int32 CaptureIndex = INDEX_NONE;
+
+	/** Received on the physics thread, skipped when applying on the game thread */
+	bool bPhysicsStep = false;
+
+	/** Points into SendCustomObjects/ReceiveCustomObjects, valid as long as these are not modified */
+	FDataContainer *CustomData = nullptr;
+
+	TArray<FMultiverseAnimJoint> Joints;
+
+	FName BoneName;
+};
+
+/** Received position and quaternion of one actor, applied with a single transform update */
+struct FMultiverseTransformBinding
+{
+	AActor *Actor = nullptr;
+
+	int32 PositionOffset = INDEX_NONE;
+
+	int32 QuaternionOffset = INDEX_NONE;
+};
+
+struct FMultiverseJointBinding
+{
+	int32 JointIndex = INDEX_NONE;
+
+	EAttribute Attribute = EAttribute::JointAngularPosition;
+
+	int32 DoubleOffset = INDEX_NONE;
+};
+
+/** Received joints of one anim instance, written with a single bulk edit of its joint poses */
+struct FMultiverseAnimBinding
+{
+	class UMultiverseAnim *Anim = nullptr;
+
+	/** Owner of Anim, compared by RemoveObject without touching the anim instance */
+	AActor *Actor = nullptr;
+
+	TArray<FMultiverseJointBinding> Joints;
+};
+
+/** Actor attribute read from or written to its Chaos particle on the physics thread */
+struct FMultiversePhysicsBinding
+{
+	AActor *Actor = nullptr;
+
+	/** Game thread only, the proxy is looked up again whenever the bindings are published */
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+
+	/** Only set in the published bindings, the body may recreate its proxy */
+	class FSingleParticlePhysicsProxy *Proxy = nullptr;
+
+	EAttribute Attribute = EAttribute::Position;
+
+	int32 DoubleOffset = 0;
+};
+
+/** Physics bindings with their proxies resolved, handed to the physics thread as a whole */
+struct FMultiversePublishedPhysicsBindings
+{
+	TArray<FMultiversePhysicsBinding> SendBindings;
+
+	TArray<FMultiversePhysicsBinding> ReceiveBindings;
+};
+
+class FMultiversePhysicsStepCallback;
+
 class MULTIVERSECONNECTOR_API FMultiverseClient : public MultiverseClient
 {
+	friend class FMultiversePhysicsStepCallback;
+
 public:
 	FMultiverseClient();
 
+	virtual ~FMultiverseClient() override;
+
 public:
 	void Init(const FString &ServerHost, const FString &ServerPort, const FString &ClientPort,
 			  const FString &WorldName, const FString &SimulationName,
@@ -118,9 +428,47 @@ public:
 			  TMap<AActor *, FAttributeContainer> &InReceiveObjects,
 			  TMap<FString, FAttributeDataContainer> *InSendCustomObjectsPtr,
 			  TMap<FString, FAttributeDataContainer> *InReceiveCustomObjectsPtr,
-			  UWorld *World);
+			  UWorld *World,
+			  const FMultiverseClientSettings &InSettings = FMultiverseClientSettings());
+
+	/**
+	 * Exchange data with the server. In async mode this only publishes the send data,
+	 * wakes up the communication thread and applies the latest completed receive data.
+	 */
+	bool Communicate();
+
+	/** Apply the received poses interpolated at the current render time, must be called every frame */
+	void UpdateInterpolation();
 
-	TMap<FString, FApiCallbacks> CallApis(const TMap<FString, FApiCallbacks> &SimulationApiCallbacks);
+	void Deinit();
+
+	/** Split the camera attributes (RGB and Depth) of the objects from the others, to stream them through their own client */
+	static void SplitSensorObjects(const TMap<AActor *, FAttributeContainer> &Objects,
+								   TMap<AActor *, FAttributeContainer> &OutObjects,
+								   TMap<AActor *, FAttributeContainer> &OutSensorObjects);
+
+	/**
+	 * Queue the API calls, they are sent with the next handshake of the exchange while the data keeps flowing.
+	 * The returned future is fulfilled once the simulator answered, or with an empty response after Timeout seconds.
+	 */
+	TFuture<TMap<FString, FApiCallbacks>> CallApis(const TMap<FString, FApiCallbacks> &SimulationApiCallbacks, float Timeout = 5.f);
+
+	/** Dispatch queued API calls and time out unanswered ones without blocking, must be called from the game thread */
+	void ProcessApiCalls();
+
+	/**
+	 * Stream one more actor while connected, only its own layout is bound.
+	 * The server learns about added and removed objects from a new handshake on the next Communicate.
+	 */
+	void AddSendObject(AActor *Actor, const FAttributeContainer &Attributes);
+
+	void AddReceiveObject(AActor *Actor, const FAttributeContainer &Attributes);
+
+	/** Stop streaming the actor, its bindings are dropped right away so that it can be destroyed before the next Communicate */
+	void RemoveObject(AActor *Actor);
+
+	/** Round-trip time and clock offset to the server, measured on every exchange */
+	FMultiverseClockStatistics GetClockStatistics() const { return ClockEstimator.GetStatistics(); }
 
 private:
 	TMap<AActor *, FAttributeContainer> SendObjects;
@@ -133,16 +481,97 @@ private:
 
 	TSharedPtr<FJsonObject> RequestMetaDataJson;
 
+	/** Send and receive layout of the actor objects, bound once and reused by every handshake until the objects change */
+	TSharedPtr<FJsonObject> SendLayoutJson;
+
+	TSharedPtr<FJsonObject> ReceiveLayoutJson;
+
+	/** Keys each actor added to the send and receive layout, to take them out again when it is removed */
+	TMap<AActor *, TArray<FString>> ObjectLayoutKeys;
+
+	/** Objects were added or removed since the last handshake */
+	bool bObjectsChanged = false;
+
+	/** Hash of the send and receive layout of the last request, sent as meta_data.layout_hash */
+	uint64 LayoutHash = 0;
+
+	/** Layout hash the server echoed as layout_hash in its last response, the next request leaves out an unchanged layout */
+	std::atomic<uint64> AcknowledgedLayoutHash = 0;
+
+	/** Set by the game thread for the exchange thread to run the next round-trip as a handshake, cleared once it is done */
+	std::atomic<bool> bRehandshakeRequested = false;
+
+	/** Response meta data except send and receive, which are read into ResponseSendData and ResponseReceiveData */
 	TSharedPtr<FJsonObject> ResponseMetaDataJson;
 
+	FMultiverseResponseData ResponseSendData;
+
+	FMultiverseResponseData ResponseReceiveData;
+
 	TArray<TPair<FString, EAttribute>> SendDataArray;
 
 	TArray<TPair<FString, EAttribute>> ReceiveDataArray;
 
+	TArray<FMultiverseBinding> SendBindings;
+
+	TArray<FMultiverseBinding> ReceiveBindings;
+
+	TArray<FMultiverseTransformBinding> ReceiveTransformBindings;
+
+	TArray<FMultiverseAnimBinding> ReceiveAnimBindings;
+
+	TArray<FMultiverseInterpolationSlot> ReceiveInterpolationSlots;
+
+	FMultiverseJitterBuffer ReceiveJitterBuffer;
+
+	FMultiverseCaptureScheduler CaptureScheduler;
+
+	/** Cameras that capture in the current frame, indexed by FMultiverseBinding::CaptureIndex */
+	TArray<bool> DueCaptures;
+
+	TArray<double> InterpolatedReceiveData;
+
 	FGraphEventRef ConnectToServerTask;
 
 	FGraphEventRef MetaDataTask;
 
+	FMultiverseClientSettings Settings;
+
+	/** Declared before the exchange threads, which use it until they are destroyed */
+	FMultiverseGameThreadCalls GameThreadCalls;
+
+	TUniquePtr<FMultiverseCommunicationThread> CommunicationThread;
+
+	FMultiversePhysicsStepCallback *PhysicsStepCallback = nullptr;
+
+	TArray<FMultiversePhysicsBinding> SendPhysicsBindings;
+
+	TArray<FMultiversePhysicsBinding> ReceivePhysicsBindings;
+
+	/** Replaced by the game thread whenever a bound body is created or destroyed, taken by every physics step */
+	TSharedPtr<const FMultiversePublishedPhysicsBindings, ESPMode::ThreadSafe> PublishedPhysicsBindings;
+
+	FCriticalSection PublishedPhysicsBindingsCriticalSection;
+
+	/** Bindings of the physics step in flight, physics thread only */
+	TSharedPtr<const FMultiversePublishedPhysicsBindings, ESPMode::ThreadSafe> PhysicsStepBindings;
+
+	FDelegateHandle CreatePhysicsStateHandle;
+
+	FDelegateHandle DestroyPhysicsStateHandle;
+
+	std::atomic<bool> bPhysicsStepRunning = false;
+
+	std::atomic<bool> bPhysicsStepInFlight = false;
+
+	std::atomic<uint32> PhysicsStepThreadId = 0;
+
+	TTripleBuffer<FMultiverseBufferSnapshot> SendSnapshots;
+
+	TTripleBuffer<FMultiverseBufferSnapshot> ReceiveSnapshots;
+
+	std::atomic<bool> bSendAndReceiveDataBound = false;
+
 private:
 	UWorld *World;
 
@@ -156,11 +585,46 @@ private:
 
 	TMap<FString, TMap<class UMultiverseAnim *, FName>> CachedBoneNames;
 
+	/** Scene captures whose render target was created when binding the meta data and their tag, released in clean_up */
+	TArray<TPair<TWeakObjectPtr<class USceneCaptureComponent2D>, FName>> BoundSceneCaptureComponents;
+
 	TMap<FLinearColor, FString> ColorMap;
 
-	float StartTime = -1.f;
+	/** Platform seconds are large after a long uptime, a float would round the world time to several milliseconds */
+	double StartTime = -1.0;
+
+	FMultiverseClockEstimator ClockEstimator;
+
+	/** Local time at which the current send data went out, only used by the thread running the round-trip */
+	double ExchangeSendTime = 0.0;
+
+	/** Server time the world has been advanced to in lockstep, negative before the first exchange */
+	double LockstepServerTime = -1.0;
+
+	/** Whether the fixed engine time step was turned on by lockstep and has to be turned off again */
+	bool bLockstepFixedTimeStep = false;
+
+	/** Fixed time step settings of the engine before lockstep took them over, restored by StopLockstep */
+	bool bPreviousUseFixedTimeStep = false;
+
+	double PreviousFixedDeltaTime = 0.0;
+
+	/** Whether lockstep paused the game to skip the world tick while the server does not step */
+	bool bLockstepPaused = false;
+
+	std::atomic<bool> bComputingRequestAndResponseMetaData = false;
+
+	TArray<FMultiverseApiCall> PendingApiCalls;
+
+	uint32 NextApiCallId = 1;
+
+	/** api_callbacks of the dispatched calls, bound into the request meta data of the next handshake */
+	TSharedPtr<FJsonObject> ApiCallbacksRequestJson;
 
-	bool bComputingRequestAndResponseMetaData = false;
+	TArray<uint32> DispatchedApiCallIds;
+
+	/** Calls whose api_callbacks went out with the last request meta data, answered by its response meta data */
+	TArray<uint32> SentApiCallIds;
 
 private:
 	void start_connect_to_server_thread() override;
@@ -199,4 +663,93 @@ private:
 
 private:
 	UMaterial *GetMaterial(const FLinearColor &Color) const;
+
+	double ComputeWorldTime() const;
+
+	/** Wall clock seconds since the client started */
+	double ComputeLocalTime() const;
+
+	/** Current server time estimated from the local time and the measured clock offset */
+	double ComputeServerTime() const;
+
+	bool IsMetaDataTaskRunning() const;
+
+	/** Set the delta time of the next frame to the step of the server since the previous exchange */
+	void AdvanceLockstep(double ServerTime);
+
+	void StopLockstep();
+
+	void SetLockstepPaused(bool bPaused);
+
+	void CancelApiCalls();
+
+	void AddObject(TMap<AActor *, FAttributeContainer> &Objects, const TSharedPtr<FJsonObject> &LayoutJson, AActor *Actor, const FAttributeContainer &Attributes);
+
+	void BindLayoutObject(const TSharedPtr<FJsonObject> &LayoutJson, const TPair<AActor *, FAttributeContainer> &Object);
+
+	/** Batch the queued API calls into the api_callbacks of the next handshake */
+	void DispatchApiCalls();
+
+	/** Fulfil the sent API calls with their part of api_callbacks_response, must be called from the game thread */
+	void ResolveApiCalls();
+
+	TMap<FString, FApiCallbacks> GetApiCallbacksResponse(const FMultiverseApiCall &ApiCall, const TSharedPtr<FJsonObject> &SimulationApiCallbacksResponseJson) const;
+
+	void GatherSendData(double *SendBufferDoubleAddr, uint8_t *SendBufferUint8Addr, uint16_t *SendBufferUint16Addr);
+
+	void GatherSendBinding(const FMultiverseBinding &SendBinding, double *SendBufferDoubleAddr, uint8_t *SendBufferUint8Addr, uint16_t *SendBufferUint16Addr) const;
+
+	void ApplyReceiveData(const double *ReceiveBufferDoubleAddr);
+
+	void ApplyReceivePoses(const double *ReceiveBufferDoubleAddr);
+
+	void CompileBindings(const TArray<TPair<FString, EAttribute>> &DataArray,
+						 const TMap<AActor *, FAttributeContainer> &Objects,
+						 TMap<FString, FAttributeDataContainer> *CustomObjectsPtr,
+						 TArray<FMultiverseBinding> &Bindings) const;
+
+	void CompileTransformBindings(const TArray<FMultiverseBinding> &Bindings, TArray<FMultiverseTransformBinding> &TransformBindings) const;
+
+	void CompileAnimBindings(const TArray<FMultiverseBinding> &Bindings, TArray<FMultiverseAnimBinding> &AnimBindings) const;
+
+	void CompilePhysicsBindings(TArray<FMultiverseBinding> &Bindings, TArray<FMultiversePhysicsBinding> &PhysicsBindings, bool bReceive) const;
+
+	void CompileInterpolationSlots();
+
+	void CompileCaptureSchedule();
+
+	void ReleaseRenderTargets();
+
+	void StartCommunicationThread();
+
+	void StopCommunicationThread();
+
+	void RegisterPhysicsStepCallback();
+
+	void UnregisterPhysicsStepCallback();
+
+	/** Resolve the proxies of the physics bindings and hand them to the physics thread, a destroyed component is left out */
+	void PublishPhysicsBindings(const UActorComponent *DestroyedComponent = nullptr);
+
+	void OnPhysicsStateCreated(UActorComponent *Component);
+
+	void OnPhysicsStateDestroyed(UActorComponent *Component);
+
+	/** Round-trip of one physics substep, called on the physics thread */
+	void CommunicatePhysicsStep();
+
+	/** Round-trip on the communication thread or the physics step, with the handshake the game thread requested */
+	void CommunicateOnExchangeThread();
+
+	void GatherPhysicsSendData(double *SendBufferDoubleAddr) const;
+
+	void ApplyPhysicsReceiveData(const double *ReceiveBufferDoubleAddr) const;
+
+	/** Whether this thread runs the round-trip off the game thread, i.e. the communication thread or the physics step */
+	bool IsExchangeThread() const;
+
+	bool IsPhysicsStepThread() const;
+
+	/** Run Function on the game thread and wait for it if called from the exchange thread, returns false otherwise */
+	bool DeferToGameThread(TFunctionRef<void()> Function);
 };
\ No newline at end of file
@@ -2,7 +2,9 @@
 
 #pragma once
 
+#include "Engine/LatentActionManager.h"
 #include "GameFramework/Actor.h"
+#include "MultiverseClient.h"
 // clang-format off
 #include "MultiverseClientActor.generated.h"
 // clang-format on
@@ -33,6 +35,10 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Multiverse Client")
 	void Init() const;
 
+	UFUNCTION(BlueprintCallable, Category = "Multiverse Client", meta = (Latent, LatentInfo = "LatentInfo"))
+	void CallApis(const TMap<FString, FApiCallbacks> &SimulationApiCallbacks, float Timeout,
+				  TMap<FString, FApiCallbacks> &SimulationApiCallbacksResponse, FLatentActionInfo LatentInfo);
+
 public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Multiverse Client")
 	UMultiverseClientComponent* MultiverseClientComponent;
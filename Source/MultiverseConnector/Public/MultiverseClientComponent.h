@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "MultiverseClient.h"
+#include "MultiverseStepScheduler.h"
 
 // clang-format off
 #include "MultiverseClientComponent.generated.h"
@@ -28,6 +29,22 @@ public:
 
 	void Deinit();
 
+	TFuture<TMap<FString, FApiCallbacks>> CallApis(const TMap<FString, FApiCallbacks> &InSimulationApiCallbacks, float Timeout = 5.f);
+
+	/** Start or stop streaming an actor after Init, announced to the server with the next exchange */
+	void AddSendObject(AActor *Actor, const FAttributeContainer &Attributes);
+
+	void AddReceiveObject(AActor *Actor, const FAttributeContainer &Attributes);
+
+	void RemoveObject(AActor *Actor);
+
+	/** ETeleportType is not a Blueprint type, Blueprints switch between None and TeleportPhysics, applied at Init */
+	UFUNCTION(BlueprintCallable, Category = "Update")
+	void SetReceiveTeleport(bool bTeleport);
+
+	UFUNCTION(BlueprintPure, Category = "Update")
+	bool GetReceiveTeleport() const;
+
 public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	FString ServerHost = TEXT("tcp://127.0.0.1");
@@ -47,9 +64,105 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	float UpdateRate = 1.0f;
 
+	/** Exchanges missed during a long frame are run back to back or merged into one */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Update")
+	EMultiverseCatchUpPolicy CatchUpPolicy = EMultiverseCatchUpPolicy::Merge;
+
+	/** Exchanges per frame at most with CatchUp, the ones beyond are dropped */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Update", meta = (ClampMin = 1))
+	int32 MaxCatchUpSteps = 4;
+
+	/** Tick group of the owning actor, e.g. TG_PrePhysics to feed the physics step or TG_PostUpdateWork to send the final poses */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Update")
+	TEnumAsByte<ETickingGroup> TickGroup = TG_PrePhysics;
+
+	/** Exchanges per second over the last second */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Update")
+	float MeasuredUpdateRate = 0.f;
+
+	/** Round-trip time and clock offset to the server, to tune UpdateRate and InterpolationDelay */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Update")
+	FMultiverseClockStatistics ClockStatistics;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	bool bAutoSendHandsAndHead = false;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bAsyncCommunication = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 ParallelGatherThreshold = 256;
+
+	/** Exchange the body states and forces before every physics substep, enable Tick Physics Async for a fixed rate */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Update")
+	bool bPhysicsStepCommunication = false;
+
+	/** Exchange every frame and step the world by the time the server advanced, UpdateRate and async modes are ignored */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Update")
+	bool bLockstep = false;
+
+	/** Seconds a frame waits in lockstep for the server to step before the world tick is skipped */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Update", meta = (ClampMin = 0))
+	float LockstepTimeout = 0.1f;
+
+	/** Teleport flag of the received transforms, set from Blueprints with SetReceiveTeleport */
+	UPROPERTY(EditAnywhere, Category = "Update")
+	ETeleportType ReceiveTeleportType = ETeleportType::None;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interpolation")
+	bool bInterpolateReceiveData = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interpolation")
+	float InterpolationDelay = 0.1f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interpolation")
+	float MaxExtrapolationTime = 0.05f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Interpolation")
+	int32 JitterBufferSize = 8;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+	bool bAsyncCameraReadback = true;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+	int32 CameraReadbackRingSize = 3;
+
+	/** uint16 depth units per Unreal unit, 10 sends millimetres */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+	float DepthScale = 10.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+	float MinDepth = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+	float MaxDepth = 6553.5f;
+
+	/** Scene captures rendered per frame at most, 0 renders all cameras that are due */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+	int32 MaxCapturesPerFrame = 0;
+
+	/** Encode the camera images before sending, the server has to decode the image_encoding of the meta data, all but None send the capture time */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera")
+	EMultiverseImageEncoding ImageEncoding = EMultiverseImageEncoding::None;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera", meta = (ClampMin = 1, ClampMax = 100))
+	int32 ImageEncodingQuality = 85;
+
+	/** Raw image bytes per byte of an encoded image slot, images that do not compress this well are dropped, 0 fits every image */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Camera", meta = (ClampMin = 0))
+	int32 ImageCompressionRatio = 0;
+
+	/** Stream the RGB and Depth attributes through a second client with its own thread, so that images do not delay poses */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Image Channel")
+	bool bSeparateImageChannel = false;
+
+	/** Port of the image client, ClientPort + 1 if empty */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Image Channel")
+	FString ImageClientPort;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Image Channel")
+	float ImageUpdateRate = 10.f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TMap<AActor*, FAttributeContainer> SendObjects;
 
@@ -68,6 +181,9 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "API Callbacks")
 	float SimulationApiCallbacksRate = 1.f;
 
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "API Callbacks")
+	float SimulationApiCallbacksTimeout = 5.f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "API Callbacks")
 	TMap<FString, FApiCallbacks> SimulationApiCallbacks;
 
@@ -77,7 +193,17 @@ public:
 private:
 	FMultiverseClient MultiverseClient;
 
-	float CurrentCycleTime = 0.f;
+	/** Only set with bSeparateImageChannel */
+	TUniquePtr<FMultiverseClient> ImageClient;
+
+	/** The image client has no custom objects */
+	TMap<FString, FAttributeDataContainer> ImageCustomObjects;
+
+	FMultiverseStepScheduler UpdateScheduler;
+
+	FMultiverseStepScheduler ImageUpdateScheduler;
 
 	float CurrentSimulationApiCycleTime = 0.f;
+
+	TFuture<TMap<FString, FApiCallbacks>> SimulationApiCallbacksFuture;
 };
@@ -0,0 +1,76 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "MultiverseClockEstimator.generated.h"
+
+/** Round-trip statistics over the last samples, in seconds */
+USTRUCT(BlueprintType)
+struct MULTIVERSECONNECTOR_API FMultiverseClockStatistics
+{
+	GENERATED_BODY()
+
+public:
+	/** Server time minus local time */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	double ClockOffset = 0.0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	double RoundTripTimeMean = 0.0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	double RoundTripTimeP50 = 0.0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	double RoundTripTimeP99 = 0.0;
+
+	/** Smoothed variation of the round-trip time between consecutive exchanges */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	double Jitter = 0.0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	int32 SampleNum = 0;
+};
+
+/**
+ * NTP-style estimation of the server clock from the timestamps of each round-trip: the local send time,
+ * the world_time of the server and the local receive time. The offset is taken from the sample with the
+ * smallest round-trip time in the window, which is the least affected by queuing delays. Thread safe.
+ */
+class MULTIVERSECONNECTOR_API FMultiverseClockEstimator
+{
+public:
+	void Reset(int32 InWindowSize = 256);
+
+	void AddSample(double SendTime, double ServerTime, double ReceiveTime);
+
+	/** Server time corresponding to a local time, the local time itself before the first sample */
+	double ToServerTime(double LocalTime) const;
+
+	FMultiverseClockStatistics GetStatistics() const;
+
+private:
+	struct FSample
+	{
+		double RoundTripTime = 0.0;
+
+		double ClockOffset = 0.0;
+	};
+
+	mutable FCriticalSection CriticalSection;
+
+	/** Ring of the last WindowSize samples */
+	TArray<FSample> Samples;
+
+	int32 WindowSize = 256;
+
+	int32 NextSample = 0;
+
+	double ClockOffset = 0.0;
+
+	double Jitter = 0.0;
+
+	double LastRoundTripTime = -1.0;
+};
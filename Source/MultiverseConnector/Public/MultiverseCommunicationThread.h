@@ -0,0 +1,93 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+/**
+ * Calls an exchange thread makes on the game thread, e.g. the bindings of a re-handshake.
+ * They run in a game thread task, or right away when the game thread is waiting for the exchange thread.
+ */
+class MULTIVERSECONNECTOR_API FMultiverseGameThreadCalls
+{
+public:
+	FMultiverseGameThreadCalls();
+
+	~FMultiverseGameThreadCalls();
+
+public:
+	/** Run Function on the game thread and wait for it to finish, must not be called from the game thread */
+	void Call(TFunctionRef<void()> Function);
+
+	/** Wake up WaitUntil, must be called after every change of the state its predicate reads */
+	void Notify();
+
+	/** Run the calls of the exchange thread until Predicate is true, other game thread tasks are not run */
+	void WaitUntil(TFunctionRef<bool()> Predicate);
+
+private:
+	struct FCall
+	{
+		FCall();
+
+		~FCall();
+
+		/** Run the function unless it already ran */
+		void Run();
+
+		FCriticalSection CriticalSection;
+
+		TFunction<void()> Function;
+
+		FEvent *DoneEvent = nullptr;
+	};
+
+	FCriticalSection CriticalSection;
+
+	TSharedPtr<FCall, ESPMode::ThreadSafe> PendingCall;
+
+	FEvent *WakeEvent = nullptr;
+};
+
+/**
+ * Dedicated thread that owns the blocking send/receive round-trip of a Multiverse client.
+ * The game thread only wakes it up, it never waits for the network.
+ */
+class MULTIVERSECONNECTOR_API FMultiverseCommunicationThread final : public FRunnable
+{
+public:
+	FMultiverseCommunicationThread(TFunction<void()> InCommunicate, const FString &ThreadName, FMultiverseGameThreadCalls &InGameThreadCalls);
+
+	virtual ~FMultiverseCommunicationThread() override;
+
+public:
+	/** Request one more round-trip, requests made while a round-trip is running are coalesced */
+	void Wake();
+
+	/** Stop the thread and wait for the running round-trip to finish, must be called from the game thread */
+	void Shutdown();
+
+	bool IsCommunicationThread() const;
+
+public:
+	// FRunnable interface
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+	// End of FRunnable interface
+
+private:
+	TFunction<void()> Communicate;
+
+	/** Must outlive the thread */
+	FMultiverseGameThreadCalls &GameThreadCalls;
+
+	FRunnableThread *Thread = nullptr;
+
+	FEvent *WakeEvent = nullptr;
+
+	std::atomic<bool> bStopRequested = false;
+
+	std::atomic<bool> bRunning = false;
+};
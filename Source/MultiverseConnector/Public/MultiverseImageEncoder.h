@@ -0,0 +1,47 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "MultiverseImageEncoder.generated.h"
+
+/** Encoding of the camera images in the send buffer, negotiated as image_encoding in the request meta data */
+UENUM(BlueprintType)
+enum class EMultiverseImageEncoding : uint8
+{
+	None,
+	/** Uncompressed, but in a slot with the header so that the capture time is sent */
+	Raw,
+	LZ4,
+	Zlib,
+	/** Lossy, depth images fall back to LZ4 */
+	JPEG
+};
+
+/**
+ * Encoded images are written into the fixed size image slot of the send buffer as a little endian uint32 byte size,
+ * the little endian float64 world time the image was captured at and the encoded bytes, the rest of the slot is left as is.
+ */
+namespace MultiverseImageEncoder
+{
+	constexpr int32 HeaderSize = sizeof(uint32) + sizeof(double);
+
+	/** Name of the encoding in the meta data */
+	MULTIVERSECONNECTOR_API const TCHAR *GetEncodingName(EMultiverseImageEncoding Encoding);
+
+	/** Encoding of images with BytesPerPixel bytes per pixel, JPEG only encodes RGB */
+	MULTIVERSECONNECTOR_API EMultiverseImageEncoding GetEffectiveEncoding(EMultiverseImageEncoding Encoding, int32 BytesPerPixel);
+
+	/** Upper bound of the encoded size of Size bytes of an image with BytesPerPixel bytes per pixel */
+	MULTIVERSECONNECTOR_API int32 GetMaxEncodedSize(EMultiverseImageEncoding Encoding, int32 Size, int32 BytesPerPixel);
+
+	/** Load what the encoding needs, must be called from the game thread before encoding on worker threads */
+	MULTIVERSECONNECTOR_API bool Initialize(EMultiverseImageEncoding Encoding);
+
+	/** Encode a tightly packed RGB (3 bytes per pixel) or uint16 depth (2 bytes per pixel) image, thread safe */
+	MULTIVERSECONNECTOR_API bool Encode(EMultiverseImageEncoding Encoding, const uint8 *Data, int32 Width, int32 Height, int32 BytesPerPixel, int32 Quality, TArray<uint8> &OutData);
+
+	/** Write the header and the encoded bytes into a slot of SlotSize bytes, false if they do not fit */
+	MULTIVERSECONNECTOR_API bool WriteToSlot(const TArray<uint8> &EncodedData, double CaptureTime, uint8 *Slot, int32 SlotSize);
+}
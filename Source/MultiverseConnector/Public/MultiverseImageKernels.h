@@ -0,0 +1,29 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Mapping of scene depth in Unreal units (cm) to the uint16 depth images that are sent */
+struct FMultiverseDepthConversion
+{
+	/** uint16 units per Unreal unit, 10 sends millimetres */
+	float Scale = 10.f;
+
+	/** Depth outside of [MinDepth, MaxDepth] (in Unreal units) is sent as 0 */
+	float MinDepth = 0.f;
+
+	float MaxDepth = 6553.5f;
+};
+
+/** Image conversions of the send path, vectorized with SSSE3 or NEON where available with a scalar remainder */
+namespace MultiverseImageKernels
+{
+	/** Pack Num BGRA pixels (RGBA if not bIsBGRA) to tightly packed RGB */
+	MULTIVERSECONNECTOR_API void PackRGB(const uint8 *Pixels, bool bIsBGRA, int32 Num, uint8 *OutRGB);
+
+	/** Convert Num depth values, read every Stride floats, to uint16 with rounding */
+	MULTIVERSECONNECTOR_API void ConvertDepthToUint16(const float *Depth, int32 Stride, int32 Num, const FMultiverseDepthConversion &DepthConversion, uint16 *OutDepth);
+
+	MULTIVERSECONNECTOR_API void ConvertDepthToUint16(const FFloat16 *Depth, int32 Stride, int32 Num, const FMultiverseDepthConversion &DepthConversion, uint16 *OutDepth);
+}
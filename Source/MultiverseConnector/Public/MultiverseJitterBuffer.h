@@ -0,0 +1,51 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EMultiverseInterpolation : uint8
+{
+	Linear,
+	AngleDegrees,
+	Quaternion
+};
+
+/** Range of the receive buffer that is interpolated between samples, quaternions are stored as w, x, y, z */
+struct FMultiverseInterpolationSlot
+{
+	int32 Offset = 0;
+
+	int32 Size = 1;
+
+	EMultiverseInterpolation Interpolation = EMultiverseInterpolation::Linear;
+};
+
+/**
+ * Keeps the last received buffers with the server time they were sampled at and reconstructs the buffer at any
+ * render time, interpolating between samples or extrapolating for a bounded time after the latest one
+ */
+class MULTIVERSECONNECTOR_API FMultiverseJitterBuffer
+{
+public:
+	void Reset(int32 InCapacity = 8);
+
+	void Push(double Time, const double *Data, int32 Num);
+
+	bool Sample(double Time, double MaxExtrapolationTime, const TArray<FMultiverseInterpolationSlot> &Slots, TArray<double> &OutData) const;
+
+	int32 Num() const { return Samples.Num(); }
+
+private:
+	struct FSample
+	{
+		double Time = 0.0;
+
+		TArray<double> Data;
+	};
+
+	/** Sorted by time, the oldest sample is recycled once Capacity is reached */
+	TArray<FSample> Samples;
+
+	int32 Capacity = 8;
+};
@@ -0,0 +1,24 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Chaos/SimCallbackInput.h"
+#include "Chaos/SimCallbackObject.h"
+#include <atomic>
+
+class FMultiverseClient;
+
+/**
+ * Chaos callback that runs before every physics substep on the physics thread.
+ * With async physics enabled the substeps run at the fixed async physics rate, independent of the frame rate.
+ */
+class MULTIVERSECONNECTOR_API FMultiversePhysicsStepCallback final : public Chaos::TSimCallbackObject<Chaos::FSimCallbackNoInput, Chaos::FSimCallbackNoOutput>
+{
+public:
+	/** Set once the callback is registered and cleared before it is unregistered, read by every substep */
+	std::atomic<FMultiverseClient *> Client = nullptr;
+
+private:
+	virtual void OnPreSimulate_Internal() override;
+};
@@ -0,0 +1,61 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USkeleton;
+
+enum class EMultiverseJointType : uint8
+{
+	Revolute,
+	Continuous,
+	Prismatic,
+	Ball,
+	/** 6-DoF joint streamed as joint_position and joint_quaternion */
+	Free
+};
+
+struct FMultiverseSkeletonJoint
+{
+	EMultiverseJointType Type = EMultiverseJointType::Revolute;
+
+	FName BoneName;
+
+	/** Bone name without the joint suffix, e.g. arm_joint for arm_joint_revolute_bone */
+	FString JointName;
+
+	/** Index in the reference skeleton of the skeleton asset */
+	int32 BoneIndex = INDEX_NONE;
+};
+
+/**
+ * Joint bones of a skeleton, classified by the suffix of their name once per skeleton and shared by
+ * every anim instance, animation node and client that works with meshes of that skeleton.
+ */
+class MULTIVERSECONNECTOR_API FMultiverseSkeletonJoints
+{
+public:
+	/** Joints of Skeleton, computed on first use, thread safe */
+	static TSharedPtr<const FMultiverseSkeletonJoints> Get(const USkeleton *Skeleton);
+
+	/** Whether BoneName is a joint bone, with its type and joint name */
+	static bool ClassifyBone(const FName &BoneName, EMultiverseJointType &OutType, FString &OutJointName);
+
+	/** Index into Joints, INDEX_NONE if the bone is not a joint */
+	int32 FindJoint(const FName &BoneName) const
+	{
+		const int32 *JointIndex = JointIndices.Find(BoneName);
+		return JointIndex != nullptr ? *JointIndex : INDEX_NONE;
+	}
+
+public:
+	/** Sorted by bone name */
+	TArray<FMultiverseSkeletonJoint> Joints;
+
+private:
+	TMap<FName, int32> JointIndices;
+
+	/** Bone count of the skeleton the joints were computed from, a skeleton that gained bones is classified again */
+	int32 BoneNum = 0;
+};
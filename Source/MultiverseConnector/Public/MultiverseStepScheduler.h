@@ -0,0 +1,57 @@
+// Copyright (c) 2023, Giang Hoang Nguyen - Institute for Artificial Intelligence, University Bremen
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include "MultiverseStepScheduler.generated.h"
+
+/** What happens with the exchanges missed during a long frame */
+UENUM(BlueprintType)
+enum class EMultiverseCatchUpPolicy : uint8
+{
+	/** Run the missed exchanges back to back, at most MaxCatchUpSteps per frame */
+	CatchUp,
+	/** Run a single exchange for all missed ones */
+	Merge
+};
+
+/**
+ * Fixed rate of the data exchange independent of the frame rate. The frame time is accumulated and whole steps are
+ * consumed, the remainder carries over to the next frame. Steps beyond MaxCatchUpSteps are dropped so that a hitch
+ * does not turn into a burst of exchanges.
+ */
+class MULTIVERSECONNECTOR_API FMultiverseStepScheduler
+{
+public:
+	void Reset(EMultiverseCatchUpPolicy InCatchUpPolicy = EMultiverseCatchUpPolicy::Merge, int32 InMaxCatchUpSteps = 4);
+
+	/** Steps per second, 0 never steps. Keeps the accumulated time */
+	void SetRate(float Rate);
+
+	/** Number of steps to run after DeltaTime seconds */
+	int32 Advance(double DeltaTime);
+
+	/** Steps per second actually run, averaged over about one second */
+	double GetMeasuredRate() const { return MeasuredRate; }
+
+	/** Steps dropped or merged since Reset */
+	int64 GetSkippedSteps() const { return SkippedSteps; }
+
+private:
+	EMultiverseCatchUpPolicy CatchUpPolicy = EMultiverseCatchUpPolicy::Merge;
+
+	int32 MaxCatchUpSteps = 4;
+
+	double StepTime = 0.0;
+
+	double AccumulatedTime = 0.0;
+
+	int64 SkippedSteps = 0;
+
+	double MeasuredRate = 0.0;
+
+	double MeasureTime = 0.0;
+
+	int32 MeasureSteps = 0;
+};